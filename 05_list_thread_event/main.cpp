@@ -12,12 +12,17 @@
 #include <thread>
 #include <vector>
 
+#include <vtp/AsyncOutputSink.hpp>
+
 using Clock = std::chrono::steady_clock;
 
 using namespace std::chrono_literals;
 
 static constexpr int PUSH_WORKERS = 3;
 
+// `list_print` 는 콘솔 출력을 기다리지 않고, flusher 스레드에 맡김
+vtp::AsyncOutputSink output(std::cout);
+
 struct ThreadParams
 {
     std::list<int>& list;
@@ -47,11 +52,11 @@ unsigned __stdcall list_print(void* params_addr)
         }
         ReleaseSRWLockShared(&params.lock);
 
-        oss.clear();
+        oss.str({});
         oss << "list: [";
         std::copy(list_content_copied.cbegin(), list_content_copied.cend(), std::ostream_iterator<int>(oss, ", "));
         oss << "]\n";
-        std::cout << oss.str();
+        output.write(oss.view());
     }
 
     return 0;
@@ -238,6 +243,7 @@ int main()
     CloseHandle(push_params.event);
     CloseHandle(save_params.event);
 
+    output.flush();
     std::cout << "Goodbye!" << std::endl;
 
     timeEndPeriod(1);
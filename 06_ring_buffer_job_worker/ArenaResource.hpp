@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+namespace vtp
+{
+
+/// Per-worker arena as a `std::pmr::memory_resource`.
+///
+/// Small blocks are bump-allocated from 64 KiB chunks, each counting its live blocks.
+/// A block can be freed from any thread (e.g. by an `EpochReclaimer`), which just decrements its chunk's count;
+/// once a chunk has no live block left, the whole chunk goes back to its arena at once, to be reused.
+///
+/// `allocate()` must only be called from the owner thread.
+/// Blocks larger than `MAX_BLOCK_SIZE` go straight to the upstream resource.
+class ArenaResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr std::size_t MAX_BLOCK_SIZE = CHUNK_SIZE / 8;
+
+private:
+    struct Chunk
+    {
+        // live blocks, plus 1 while it's the chunk being allocated from
+        std::atomic<std::uint32_t> live = 1;
+        ArenaResource* const owner;
+        Chunk* next_drained = nullptr;
+
+        explicit Chunk(ArenaResource* owner_) : owner(owner_)
+        {
+        }
+
+        auto begin() -> std::byte*
+        {
+            return reinterpret_cast<std::byte*>(this + 1);
+        }
+
+        auto end() -> std::byte*
+        {
+            return reinterpret_cast<std::byte*>(this) + CHUNK_SIZE;
+        }
+
+        /// Chunks are `CHUNK_SIZE` aligned, so masking a block address gives its chunk.
+        static auto of(void* block) -> Chunk*
+        {
+            return reinterpret_cast<Chunk*>(reinterpret_cast<std::uintptr_t>(block) & ~(CHUNK_SIZE - 1));
+        }
+    };
+
+public:
+    struct Stats
+    {
+        std::uint64_t chunks_allocated; // from upstream
+        std::uint64_t chunks_reused;    // drained, then allocated from again
+        std::uint64_t large_blocks;     // bypassed the arena
+    };
+
+public:
+    explicit ArenaResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : _upstream(upstream)
+    {
+    }
+
+    ~ArenaResource() override
+    {
+        // 살아있는 블록이 남았어도, 청크째로 한 번에 반환
+        for (Chunk* chunk : _chunks)
+        {
+            chunk->~Chunk();
+            ::operator delete(chunk, std::align_val_t(CHUNK_SIZE));
+        }
+    }
+
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+public:
+    /// Call after the owner thread is done allocating.
+    auto stats() const -> Stats
+    {
+        return {_chunks_allocated, _chunks_reused, _large_blocks};
+    }
+
+protected:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override
+    {
+        if (bytes > MAX_BLOCK_SIZE || alignment > alignof(std::max_align_t))
+        {
+            ++_large_blocks;
+            return _upstream->allocate(bytes, alignment);
+        }
+
+        auto aligned = align_up(_cursor, alignment);
+        if (!_current || aligned + bytes > _current->end())
+        {
+            next_chunk();
+            aligned = align_up(_cursor, alignment);
+        }
+
+        _current->live.fetch_add(1, std::memory_order_relaxed);
+        _cursor = aligned + bytes;
+        return aligned;
+    }
+
+    void do_deallocate(void* block, std::size_t bytes, std::size_t alignment) override
+    {
+        if (bytes > MAX_BLOCK_SIZE || alignment > alignof(std::max_align_t))
+        {
+            _upstream->deallocate(block, bytes, alignment);
+            return;
+        }
+
+        release(Chunk::of(block));
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    static auto align_up(std::byte* ptr, std::size_t alignment) -> std::byte*
+    {
+        const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+        return reinterpret_cast<std::byte*>((addr + alignment - 1) & ~(alignment - 1));
+    }
+
+    /// Drops a reference to `chunk`; the last one hands it back to its owner, from any thread.
+    static void release(Chunk* chunk)
+    {
+        if (1 == chunk->live.fetch_sub(1, std::memory_order_acq_rel))
+            chunk->owner->push_drained(chunk);
+    }
+
+    void push_drained(Chunk* chunk)
+    {
+        chunk->next_drained = _drained.load(std::memory_order_relaxed);
+        while (!_drained.compare_exchange_weak(chunk->next_drained, chunk, std::memory_order_release,
+                                               std::memory_order_relaxed))
+            ;
+    }
+
+    void next_chunk()
+    {
+        if (_current)
+            release(_current);
+
+        // 다 비워진 청크가 있으면 재사용 (소유자만 꺼내니, 통째로 가져가면 ABA 없음)
+        if (!_spare)
+            _spare = _drained.exchange(nullptr, std::memory_order_acquire);
+
+        if (_spare)
+        {
+            _current = _spare;
+            _spare = _spare->next_drained;
+            _current->live.store(1, std::memory_order_relaxed);
+            ++_chunks_reused;
+        }
+        else
+        {
+            void* mem = ::operator new(CHUNK_SIZE, std::align_val_t(CHUNK_SIZE));
+            _current = new (mem) Chunk(this);
+            _chunks.push_back(_current);
+            ++_chunks_allocated;
+        }
+
+        _cursor = _current->begin();
+    }
+
+private:
+    std::pmr::memory_resource* const _upstream;
+
+    // owner thread only
+    Chunk* _current = nullptr;
+    std::byte* _cursor = nullptr;
+    Chunk* _spare = nullptr;
+    std::vector<Chunk*> _chunks;
+
+    std::uint64_t _chunks_allocated = 0;
+    std::uint64_t _chunks_reused = 0;
+    std::uint64_t _large_blocks = 0;
+
+    // pushed by any thread whose free drained a chunk
+    std::atomic<Chunk*> _drained = nullptr;
+};
+
+} // namespace vtp
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace vtp
+{
+
+/// Fixed-capacity Chase-Lev work-stealing deque.
+///
+/// The owner thread `push()`es and `pop()`s at the bottom (LIFO),
+/// any other thread `steal()`s from the top (FIFO).
+///
+/// Memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013).
+/// Elements are stored as `std::atomic<T>`, so `T` should be small enough to be lock-free (e.g. an index).
+template <typename T>
+    requires std::atomic<T>::is_always_lock_free
+class ChaseLevDeque
+{
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+public:
+    /// @param capacity must be a power of 2
+    explicit ChaseLevDeque(std::size_t capacity)
+        : _buffer(std::make_unique<std::atomic<T>[]>(check_capacity(capacity))),
+          _mask(static_cast<std::int64_t>(capacity) - 1)
+    {
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+public:
+    /// Approximate, as thieves might be stealing concurrently.
+    auto size_approx() const -> std::size_t
+    {
+        const auto bottom = _bottom.load(std::memory_order_relaxed);
+        const auto top = _top.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+
+    bool empty_approx() const
+    {
+        return 0 == size_approx();
+    }
+
+public: // Owner only
+    /// @return `false` if the deque was full
+    bool push(T value)
+    {
+        const auto bottom = _bottom.load(std::memory_order_relaxed);
+        const auto top = _top.load(std::memory_order_acquire);
+        if (bottom - top > _mask)
+            return false;
+
+        _buffer[bottom & _mask].store(value, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @return `false` if the deque was empty
+    bool pop(T& value)
+    {
+        const auto bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) // empty
+        {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        value = _buffer[bottom & _mask].load(std::memory_order_relaxed);
+        if (top == bottom) // last one, race against thieves
+        {
+            const bool won =
+                _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+public: // Any thread
+    /// @return `false` if the deque was empty, or lost the race against the owner or another thief
+    bool steal(T& value)
+    {
+        auto top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) // empty
+            return false;
+
+        value = _buffer[top & _mask].load(std::memory_order_relaxed);
+        return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    static auto check_capacity(std::size_t capacity) -> std::size_t
+    {
+        if (capacity < 2 || (capacity & (capacity - 1)))
+            throw std::invalid_argument("ChaseLevDeque capacity must be a power of 2");
+        return capacity;
+    }
+
+private:
+    const std::unique_ptr<std::atomic<T>[]> _buffer;
+    const std::int64_t _mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _top = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _bottom = 0;
+};
+
+} // namespace vtp
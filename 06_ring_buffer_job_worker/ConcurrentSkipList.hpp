@@ -0,0 +1,317 @@
+#pragma once
+
+#include "EpochReclaimer.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <random>
+#include <thread>
+#include <utility>
+
+namespace vtp
+{
+
+/// Lock-free sorted multiset, as a skip list of marked pointers
+/// (Herlihy & Shavit, "The Art of Multiprocessor Programming", 14.4).
+///
+/// Always kept sorted, so there's no separate sort step.
+/// `insert()`, `contains()` and `pop_front()` are O(log n) expected; `for_each()` walks the bottom level in order.
+/// Unlinked nodes are freed through an `EpochReclaimer`.
+///
+/// Equal keys are told apart by an insertion sequence number, so they pop in insertion order.
+///
+/// Each node is allocated from the `std::pmr::memory_resource` passed to `insert()`, e.g. the inserting worker's arena,
+/// and an allocator-aware `Key` (e.g. `std::pmr::string`) keeps its own buffer there too.
+template <typename Key, typename Compare = std::less<>>
+class ConcurrentSkipList
+{
+private:
+    static constexpr int MAX_LEVEL = 24;
+
+    struct Node;
+
+    /// Pointer to the next node, with its lowest bit marking this node as deleted at that level.
+    using Link = std::atomic<std::uintptr_t>;
+
+    static constexpr std::uintptr_t MARK = 1;
+
+    static auto ptr(std::uintptr_t link) -> Node*
+    {
+        return reinterpret_cast<Node*>(link & ~MARK);
+    }
+
+    static bool marked(std::uintptr_t link)
+    {
+        return link & MARK;
+    }
+
+    static auto link_to(Node* node) -> std::uintptr_t
+    {
+        return reinterpret_cast<std::uintptr_t>(node);
+    }
+
+    /// Variable height node: `Node` itself, followed by `level` links.
+    struct Node
+    {
+        std::pmr::memory_resource* const resource;
+        const Key key;
+        const std::uint64_t seq;
+        const int level;
+
+        // `pop_front()` waits for this, so that no one links a node being deleted
+        std::atomic<bool> fully_linked = false;
+
+        template <typename K>
+        Node(std::pmr::memory_resource* resource_, K&& key_, std::uint64_t seq_, int level_)
+            : resource(resource_),
+              key(std::make_obj_using_allocator<Key>(std::pmr::polymorphic_allocator<>(resource_),
+                                                     std::forward<K>(key_))),
+              seq(seq_), level(level_)
+        {
+            for (int i = 0; i < level; ++i)
+                new (&next(i)) Link(0);
+        }
+
+        auto next(int i) -> Link&
+        {
+            return reinterpret_cast<Link*>(this + 1)[i];
+        }
+
+        static auto size(int level) -> std::size_t
+        {
+            return sizeof(Node) + level * sizeof(Link);
+        }
+
+        template <typename K>
+        static auto create(std::pmr::memory_resource* resource, K&& key, std::uint64_t seq, int level) -> Node*
+        {
+            void* mem = resource->allocate(size(level), alignof(Node));
+            return new (mem) Node(resource, std::forward<K>(key), seq, level);
+        }
+
+        static void destroy(void* mem)
+        {
+            Node* node = static_cast<Node*>(mem);
+            std::pmr::memory_resource* const resource = node->resource;
+            const int level = node->level;
+
+            node->~Node();
+            resource->deallocate(mem, size(level), alignof(Node));
+        }
+    };
+
+    static_assert(alignof(Node) >= alignof(Link));
+
+public:
+    ConcurrentSkipList() : _head(Node::create(std::pmr::get_default_resource(), Key{}, 0, MAX_LEVEL))
+    {
+    }
+
+    ~ConcurrentSkipList()
+    {
+        for (Node* node = _head; node;)
+        {
+            Node* next = ptr(node->next(0).load(std::memory_order_relaxed));
+            Node::destroy(node);
+            node = next;
+        }
+    }
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+public: // Capacity
+    auto size_approx() const -> std::size_t
+    {
+        return _size.load(std::memory_order_relaxed);
+    }
+
+public: // Modifiers
+    /// Constructs a `Key` from `key` in a new node allocated from `resource`.
+    /// `resource` must outlive the node, which might be freed later on another thread.
+    template <typename K>
+    void insert(K&& key, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        const auto guard = _reclaimer.guard();
+
+        const std::uint64_t seq = _next_seq.fetch_add(1, std::memory_order_relaxed);
+        Node* const node = Node::create(resource, std::forward<K>(key), seq, random_level());
+
+        Node* preds[MAX_LEVEL];
+        Node* succs[MAX_LEVEL];
+
+        // 맨 아래 층에 끼워넣으면 논리적으로 추가된 것
+        for (;;)
+        {
+            find(node->key, seq, preds, succs);
+            node->next(0).store(link_to(succs[0]), std::memory_order_relaxed);
+
+            std::uintptr_t expected = link_to(succs[0]);
+            if (preds[0]->next(0).compare_exchange_strong(expected, link_to(node)))
+                break;
+        }
+        _size.fetch_add(1, std::memory_order_relaxed);
+
+        // 위층은 검색을 빠르게 할 뿐이니, 하나씩 천천히 연결
+        for (int level = 1; level < node->level; ++level)
+        {
+            for (;;)
+            {
+                node->next(level).store(link_to(succs[level]), std::memory_order_relaxed);
+
+                std::uintptr_t expected = link_to(succs[level]);
+                if (preds[level]->next(level).compare_exchange_strong(expected, link_to(node)))
+                    break;
+                find(node->key, seq, preds, succs);
+            }
+        }
+
+        node->fully_linked.store(true, std::memory_order_release);
+    }
+
+    /// Removes the smallest key.
+    auto pop_front() -> std::optional<Key>
+    {
+        const auto guard = _reclaimer.guard();
+
+        for (;;)
+        {
+            // 논리적으로 삭제되지 않은 첫 노드
+            Node* node = ptr(_head->next(0).load());
+            while (node && marked(node->next(0).load()))
+                node = ptr(node->next(0).load());
+            if (!node)
+                return std::nullopt;
+
+            // 아직 위층을 연결하는 중이면 잠시 기다림
+            if (!node->fully_linked.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // 위층부터 표시하고, 맨 아래 층을 표시한 스레드가 삭제의 주인
+            for (int level = node->level - 1; level >= 1; --level)
+                node->next(level).fetch_or(MARK);
+            if (marked(node->next(0).fetch_or(MARK)))
+                continue;
+
+            std::optional<Key> key(node->key);
+            _size.fetch_sub(1, std::memory_order_relaxed);
+
+            // 모든 층에서 떼어낸 뒤 은퇴
+            Node* preds[MAX_LEVEL];
+            Node* succs[MAX_LEVEL];
+            find(node->key, node->seq, preds, succs);
+            _reclaimer.retire(node, &Node::destroy);
+
+            return key;
+        }
+    }
+
+public: // Lookup
+    template <typename K>
+    bool contains(const K& key)
+    {
+        const auto guard = _reclaimer.guard();
+
+        Node* preds[MAX_LEVEL];
+        Node* succs[MAX_LEVEL];
+
+        // sequence number 0 은 같은 키 중 맨 앞
+        find(key, 0, preds, succs);
+        return succs[0] && !_compare(key, succs[0]->key) && !_compare(succs[0]->key, key);
+    }
+
+    /// Calls `func(const Key&)` for every key, in order.
+    /// Keys inserted or removed meanwhile might or might not be visited.
+    template <typename Func>
+    void for_each(Func&& func)
+    {
+        const auto guard = _reclaimer.guard();
+
+        for (Node* node = ptr(_head->next(0).load()); node;)
+        {
+            const std::uintptr_t next = node->next(0).load();
+            if (!marked(next))
+                func(node->key);
+            node = ptr(next);
+        }
+    }
+
+private:
+    template <typename K>
+    bool less(const Node* node, const K& key, std::uint64_t seq) const
+    {
+        if (_compare(node->key, key))
+            return true;
+        if (_compare(key, node->key))
+            return false;
+        return node->seq < seq;
+    }
+
+    /// Fills `preds` and `succs` around `(key, seq)` on every level, unlinking marked nodes on the way.
+    template <typename K>
+    void find(const K& key, std::uint64_t seq, Node** preds, Node** succs)
+    {
+    retry:
+        Node* pred = _head;
+        for (int level = MAX_LEVEL - 1; level >= 0; --level)
+        {
+            Node* curr = ptr(pred->next(level).load());
+            while (curr)
+            {
+                std::uintptr_t succ = curr->next(level).load();
+
+                // 이 층에서 삭제된 노드는 떼어냄
+                while (marked(succ))
+                {
+                    std::uintptr_t expected = link_to(curr);
+                    if (!pred->next(level).compare_exchange_strong(expected, succ & ~MARK))
+                        goto retry;
+
+                    curr = ptr(succ);
+                    if (!curr)
+                        break;
+                    succ = curr->next(level).load();
+                }
+                if (!curr || !less(curr, key, seq))
+                    break;
+
+                pred = curr;
+                curr = ptr(succ);
+            }
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+    }
+
+    static auto random_level() -> int
+    {
+        thread_local std::minstd_rand rng(
+            static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+
+        // 1/2 확률로 한 층씩 높아짐
+        int level = 1;
+        while (level < MAX_LEVEL && (rng() % 2))
+            ++level;
+        return level;
+    }
+
+private:
+    Node* const _head;
+    [[no_unique_address]] Compare _compare;
+
+    std::atomic<std::size_t> _size = 0;
+    std::atomic<std::uint64_t> _next_seq = 1;
+
+    EpochReclaimer _reclaimer;
+};
+
+} // namespace vtp
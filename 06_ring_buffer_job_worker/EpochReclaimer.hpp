@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace vtp
+{
+
+/// Epoch-based reclamation (Fraser, "Practical lock-freedom", 2004) for lock-free containers.
+///
+/// Readers hold a `Guard` while they might dereference shared nodes.
+/// Unlinked nodes are `retire()`d, and freed only after every thread has left the epoch they were unlinked in.
+class EpochReclaimer
+{
+public:
+    static constexpr int MAX_THREADS = 256;
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    /// Try to advance the epoch and free old nodes every this many `retire()`s.
+    static constexpr std::size_t RECLAIM_THRESHOLD = 64;
+
+    static constexpr std::uint64_t INACTIVE = 0;
+
+    struct Retired
+    {
+        void* ptr;
+        void (*deleter)(void*);
+        std::uint64_t epoch;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) ThreadRecord
+    {
+        std::atomic<std::uint64_t> epoch = INACTIVE;
+        int nesting = 0; // owner thread only
+
+        // owner thread only, or whoever reuses this thread index later
+        std::vector<Retired> limbo;
+    };
+
+public:
+    class Guard
+    {
+    public:
+        explicit Guard(EpochReclaimer& reclaimer) : _record(reclaimer.my_record())
+        {
+            if (0 == _record.nesting++)
+                _record.epoch.store(reclaimer._global_epoch.load());
+        }
+
+        ~Guard()
+        {
+            if (0 == --_record.nesting)
+                _record.epoch.store(INACTIVE, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        ThreadRecord& _record;
+    };
+
+public:
+    EpochReclaimer() : _records(std::make_unique<ThreadRecord[]>(MAX_THREADS))
+    {
+    }
+
+    ~EpochReclaimer()
+    {
+        for (int i = 0; i < MAX_THREADS; ++i)
+            for (const Retired& retired : _records[i].limbo)
+                retired.deleter(retired.ptr);
+    }
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+public:
+    auto guard() -> Guard
+    {
+        return Guard(*this);
+    }
+
+    /// Frees `ptr` with `deleter` once no `Guard` could still be reading it.
+    /// `ptr` must already be unreachable from the container.
+    void retire(void* ptr, void (*deleter)(void*))
+    {
+        ThreadRecord& record = my_record();
+        record.limbo.push_back({ptr, deleter, _global_epoch.load()});
+
+        if (record.limbo.size() >= RECLAIM_THRESHOLD)
+            reclaim(record);
+    }
+
+private:
+    void reclaim(ThreadRecord& record)
+    {
+        try_advance();
+
+        // 2 에포크 전에 은퇴한 노드는, 그걸 볼 수 있었던 스레드가 모두 떠났음
+        const std::uint64_t safe_epoch = _global_epoch.load() - 2;
+        std::erase_if(record.limbo, [safe_epoch](const Retired& retired) {
+            if (retired.epoch > safe_epoch)
+                return false;
+            retired.deleter(retired.ptr);
+            return true;
+        });
+    }
+
+    void try_advance()
+    {
+        std::uint64_t epoch = _global_epoch.load();
+        for (int i = 0; i < MAX_THREADS; ++i)
+        {
+            const std::uint64_t thread_epoch = _records[i].epoch.load();
+            if (INACTIVE != thread_epoch && epoch != thread_epoch)
+                return;
+        }
+        _global_epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    auto my_record() -> ThreadRecord&
+    {
+        return _records[thread_index()];
+    }
+
+    /// Process-wide index of the calling thread, recycled when the thread exits.
+    static auto thread_index() -> int
+    {
+        struct Indices
+        {
+            std::mutex lock;
+            std::vector<int> free;
+            int next = 0;
+        };
+        static Indices indices;
+
+        struct ThreadIndex
+        {
+            int index;
+
+            ThreadIndex()
+            {
+                std::lock_guard guard(indices.lock);
+                if (!indices.free.empty())
+                {
+                    index = indices.free.back();
+                    indices.free.pop_back();
+                }
+                else if (indices.next < MAX_THREADS)
+                    index = indices.next++;
+                else
+                    throw std::runtime_error("EpochReclaimer: too many threads");
+            }
+
+            ~ThreadIndex()
+            {
+                std::lock_guard guard(indices.lock);
+                indices.free.push_back(index);
+            }
+        };
+        thread_local ThreadIndex thread_index;
+
+        return thread_index.index;
+    }
+
+private:
+    // starts from 2, so that `epoch - 2` never underflows, and never hits `INACTIVE`
+    std::atomic<std::uint64_t> _global_epoch = 2;
+    const std::unique_ptr<ThreadRecord[]> _records;
+};
+
+} // namespace vtp
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <NetBuff/RingByteBuffer.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+namespace vtp
+{
+
+/// Length-prefixed frames on top of a ring byte buffer, with every frame body kept contiguous.
+///
+/// Producers `reserve()` a span inside the ring, construct the frame in place, then `commit()` it.
+/// Consumers `peek()` the oldest frame as a span inside the ring, then `consume()` it.
+///
+/// When a frame doesn't fit before the end of the buffer, the tail is skipped with a padding record
+/// (or silently, if the tail is even smaller than a frame header), and the frame is placed at the beginning.
+///
+/// Not thread-safe; producers and consumers must be synchronized externally.
+template <typename Buffer = nb::RingByteBuffer<>>
+class FrameRingBuffer
+{
+private:
+    using FrameHeader = std::uint32_t;
+
+    static constexpr std::size_t HEADER_SIZE = sizeof(FrameHeader);
+    static constexpr FrameHeader PADDING_FLAG = FrameHeader(1) << 31;
+
+public:
+    static constexpr std::size_t MAX_FRAME_LENGTH = PADDING_FLAG - 1;
+
+public:
+    explicit FrameRingBuffer(std::size_t capacity_bytes) : _buf(capacity_bytes)
+    {
+    }
+
+public: // Capacity
+    bool empty() const
+    {
+        return _buf.empty();
+    }
+
+    /// Bytes used, including frame headers and paddings.
+    auto used_space() const -> std::size_t
+    {
+        return _buf.used_space();
+    }
+
+public: // Producer
+    /// Reserves a contiguous span of `length` bytes for the next frame.
+    /// @return `std::nullopt` if there's not enough space
+    auto reserve(std::size_t length) -> std::optional<std::span<std::byte>>
+    {
+        assert(length <= MAX_FRAME_LENGTH);
+
+        const std::size_t needed = HEADER_SIZE + length;
+        std::size_t contiguous = _buf.consecutive_write_length();
+        if (contiguous < needed)
+        {
+            // 끝까지 남은 공간이 부족한데, 앞쪽에 빈 공간이 있으면 끝부분을 패딩으로 채우고 앞에서 다시 시도
+            const std::size_t available = _buf.available_space();
+            if (available <= contiguous || available - contiguous < needed)
+                return std::nullopt;
+
+            pad(contiguous);
+            contiguous = _buf.consecutive_write_length();
+            if (contiguous < needed)
+                return std::nullopt;
+        }
+
+        return std::span(_buf.data() + _buf.write_pos() + HEADER_SIZE, length);
+    }
+
+    /// Publishes the frame constructed in the last `reserve()`d span.
+    /// @param length can be shorter than the reserved length
+    void commit(std::size_t length)
+    {
+        assert(_buf.consecutive_write_length() >= HEADER_SIZE + length);
+
+        const auto header = static_cast<FrameHeader>(length);
+        std::memcpy(_buf.data() + _buf.write_pos(), &header, HEADER_SIZE);
+        _buf.move_write_pos(HEADER_SIZE + length);
+    }
+
+public: // Consumer
+    /// Returns the oldest frame without consuming it, skipping paddings on the way.
+    /// @return `std::nullopt` if there's no frame
+    auto peek() -> std::optional<std::span<const std::byte>>
+    {
+        for (;;)
+        {
+            if (_buf.empty())
+                return std::nullopt;
+
+            // 프레임은 항상 헤더와 함께 통째로 commit 되니,
+            // 헤더조차 못 들어가는 끝부분은 생산자가 말없이 건너뛴 패딩
+            const std::size_t contiguous = _buf.consecutive_read_length();
+            if (contiguous < HEADER_SIZE)
+            {
+                _buf.move_read_pos(contiguous);
+                continue;
+            }
+
+            FrameHeader header;
+            std::memcpy(&header, _buf.data() + _buf.read_pos(), HEADER_SIZE);
+
+            const std::size_t length = header & ~PADDING_FLAG;
+            if (header & PADDING_FLAG)
+            {
+                _buf.move_read_pos(HEADER_SIZE + length);
+                continue;
+            }
+
+            assert(contiguous >= HEADER_SIZE + length);
+            return std::span<const std::byte>(_buf.data() + _buf.read_pos() + HEADER_SIZE, length);
+        }
+    }
+
+    /// Consumes the frame returned from the last `peek()`.
+    void consume(std::span<const std::byte> frame)
+    {
+        assert(frame.data() == _buf.data() + _buf.read_pos() + HEADER_SIZE);
+
+        _buf.move_read_pos(HEADER_SIZE + frame.size());
+    }
+
+private:
+    void pad(std::size_t length)
+    {
+        if (length >= HEADER_SIZE)
+        {
+            const auto header = static_cast<FrameHeader>((length - HEADER_SIZE) | PADDING_FLAG);
+            std::memcpy(_buf.data() + _buf.write_pos(), &header, HEADER_SIZE);
+        }
+        _buf.move_write_pos(length);
+    }
+
+private:
+    Buffer _buf;
+};
+
+} // namespace vtp
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VTP_JOB_CLOCK_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace vtp
+{
+
+/// Cheap timestamps for job tracing.
+///
+/// On x86-64, reads the TSC (a few ns, no syscall), assuming an invariant TSC synchronized across cores,
+/// as on any recent x86-64 CPU; `elapsed_ns()` converts with a ratio that `calibrate()` measures against
+/// `std::chrono::steady_clock`.
+/// Elsewhere, just `std::chrono::steady_clock` in nanoseconds.
+struct JobClock
+{
+    /// Measures the TSC ratio, sleeping 10 ms: call once at startup, before any thread calls `elapsed_ns()`.
+    /// (`JobTracer` does, on construction)
+    static void calibrate()
+    {
+#if defined(VTP_JOB_CLOCK_TSC)
+        using SteadyClock = std::chrono::steady_clock;
+
+        const auto steady_begin = SteadyClock::now();
+        const std::uint64_t tsc_begin = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const std::uint64_t tsc_end = __rdtsc();
+        const std::chrono::duration<double, std::nano> elapsed = SteadyClock::now() - steady_begin;
+
+        _ns_per_tick = elapsed.count() / static_cast<double>(tsc_end - tsc_begin);
+#endif
+    }
+
+    static auto now() -> std::uint64_t
+    {
+#if defined(VTP_JOB_CLOCK_TSC)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    /// Nanoseconds from `begin` to `end`, both from `now()`.
+    /// Clamped to 0, in case the TSC of two cores are a few ticks apart.
+    static auto elapsed_ns(std::uint64_t begin, std::uint64_t end) -> std::uint64_t
+    {
+        if (end <= begin)
+            return 0;
+#if defined(VTP_JOB_CLOCK_TSC)
+        assert(_ns_per_tick > 0 && "JobClock::calibrate() not called");
+        return static_cast<std::uint64_t>(static_cast<double>(end - begin) * _ns_per_tick);
+#else
+        return end - begin;
+#endif
+    }
+
+private:
+#if defined(VTP_JOB_CLOCK_TSC)
+    // 워커들이 뜨기 전에 한 번 쓰이고, 이후로는 읽기만 함
+    static inline double _ns_per_tick = 0;
+#endif
+};
+
+} // namespace vtp
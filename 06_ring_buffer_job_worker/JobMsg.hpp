@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace vtp
+{
+
+enum class JobMsgType : std::uint8_t
+{
+    LIST_PUSH_BACK,
+    LIST_POP_FRONT,
+    LIST_SORT,
+    LIST_FIND,
+    LIST_PRINT,
+    QUIT,
+};
+
+static constexpr std::size_t JOB_MSG_TYPE_COUNT = static_cast<std::size_t>(JobMsgType::QUIT) + 1;
+
+constexpr auto to_string(JobMsgType type) -> std::string_view
+{
+    constexpr std::string_view NAMES[] = {
+        "LIST_PUSH_BACK", "LIST_POP_FRONT", "LIST_SORT", "LIST_FIND", "LIST_PRINT", "QUIT",
+    };
+    static_assert(std::size(NAMES) == JOB_MSG_TYPE_COUNT);
+
+    const auto index = static_cast<std::size_t>(type);
+    return index < JOB_MSG_TYPE_COUNT ? NAMES[index] : "UNKNOWN";
+}
+
+/// Priority lane of a job in a `LaneJobQueue`.
+enum class JobLane : std::uint8_t
+{
+    CONTROL, // e.g. `QUIT`, always popped first
+    LATENCY, // short jobs someone is waiting on
+    BULK,    // long or background jobs
+};
+
+static constexpr std::size_t JOB_LANE_COUNT = static_cast<std::size_t>(JobLane::BULK) + 1;
+
+struct JobMsgHeader
+{
+    JobMsgType type;
+    std::uint8_t payload_length;
+#if defined(VTP_JOB_TRACING)
+    // `JobClock` ticks, stamped by the queue on push
+    std::uint64_t enqueued = 0;
+#endif
+};
+
+static constexpr std::size_t MAX_JOB_PAYLOAD_LENGTH =
+    std::numeric_limits<decltype(JobMsgHeader::payload_length)>::max();
+
+/// Fixed-size job message, with its payload stored inline.
+struct JobMsg
+{
+    JobMsgHeader header;
+    char payload[MAX_JOB_PAYLOAD_LENGTH];
+
+    auto payload_view() const -> std::string_view
+    {
+        return std::string_view(payload, header.payload_length);
+    }
+
+    void assign(const JobMsgHeader& header_, std::string_view payload_)
+    {
+        header = header_;
+        payload_.copy(payload, payload_.size());
+    }
+};
+
+/// Worker-local buffer for batched dequeue.
+struct JobBatch
+{
+    std::vector<JobMsg> msgs;
+    std::size_t count = 0;
+
+    explicit JobBatch(std::size_t capacity) : msgs(capacity)
+    {
+    }
+
+    auto view() const -> std::span<const JobMsg>
+    {
+        return std::span(msgs.data(), count);
+    }
+};
+
+/// Adaptive batch size for batched dequeue:
+/// each worker takes its fair share of the queued jobs, capped at `max_batch`.
+///
+/// A shallow queue is still spread over all workers one by one,
+/// while a burst is drained in big batches to amortize the lock and the wakeup.
+struct BatchPolicy
+{
+    std::size_t max_batch = 1;
+    std::size_t workers = 1;
+
+    auto batch_size(std::size_t queue_depth) const -> std::size_t
+    {
+        return std::clamp<std::size_t>((queue_depth + workers - 1) / workers, 1, max_batch);
+    }
+};
+
+} // namespace vtp
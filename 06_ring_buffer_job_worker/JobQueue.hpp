@@ -0,0 +1,255 @@
+#pragma once
+
+#include "FrameRingBuffer.hpp"
+#include "JobMsg.hpp"
+#include "MpmcBoundedQueue.hpp"
+#include "QueueBackpressure.hpp"
+#include "auto_reset_event_cxxstd.hpp"
+
+#include <NetBuff/RingByteBuffer.hpp>
+#include <vtp/MirroredRingBuffer.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace vtp
+{
+
+/// Job queue of variable-length frames in a ring byte buffer, guarded by a single mutex.
+/// Every producer write and every worker read serializes on `_lock`.
+///
+/// Each frame is a `JobMsgHeader` followed by its payload, constructed in place inside the ring.
+///
+/// @tparam Buffer `nb::RingByteBuffer<>` or `MirroredRingBuffer`; the latter never needs wrap-around padding.
+template <typename Buffer>
+class BasicRingJobQueue : public BoundedJobQueue<BasicRingJobQueue<Buffer>>
+{
+    friend class BoundedJobQueue<BasicRingJobQueue>;
+
+public:
+    explicit BasicRingJobQueue(std::size_t capacity_bytes) : _queue(capacity_bytes)
+    {
+    }
+
+    /// Blocks until a message is available, then pops it with `read(const JobMsgHeader&, std::string_view)`.
+    /// The payload view points into the ring, and is valid only inside `read`, which runs under `_lock`.
+    template <typename Reader>
+    void pop_with(Reader&& read)
+    {
+        std::unique_lock guard(_lock);
+        auto frame = wait_frame(guard);
+
+        const JobMsgHeader header = read_header(frame);
+        read(header, payload_of(frame, header));
+        _queue.consume(frame);
+
+        // 일감이 더 남았으면, 다른 워커도 깨움
+        if (!_queue.empty())
+            _event.set();
+
+        guard.unlock();
+        this->_backpressure.popped();
+    }
+
+    /// Blocks until a message is available, and copies it into `msg`.
+    void pop(JobMsg& msg)
+    {
+        pop_with([&msg](const JobMsgHeader& header, std::string_view payload) { msg.assign(header, payload); });
+    }
+
+    /// Blocks until a message is available, then copies up to `policy.batch_size()` messages into `batch`
+    /// in a single critical section. The batch ends early right after a `QUIT`.
+    void pop_batch(JobBatch& batch, const BatchPolicy& policy)
+    {
+        std::unique_lock guard(_lock);
+        auto frame = wait_frame(guard);
+
+        const std::size_t batch_size = std::min(policy.batch_size(this->_backpressure.depth()), batch.msgs.size());
+        batch.count = 0;
+        for (;;)
+        {
+            JobMsg& msg = batch.msgs[batch.count++];
+            const JobMsgHeader header = read_header(frame);
+            msg.assign(header, payload_of(frame, header));
+            _queue.consume(frame);
+
+            if (JobMsgType::QUIT == header.type || batch.count >= batch_size)
+                break;
+
+            const auto next = _queue.peek();
+            if (!next)
+                break;
+            frame = *next;
+        }
+
+        if (!_queue.empty())
+            _event.set();
+
+        guard.unlock();
+        this->_backpressure.popped(batch.count);
+    }
+
+    /// Wakes up a waiting worker, e.g. to pass on the `QUIT` chain.
+    void notify()
+    {
+        _event.set();
+    }
+
+private:
+    using Frame = std::span<const std::byte>;
+
+    /// Single push attempt, followed by waking up a worker.
+    /// @return `false` if there was not enough space for the whole message
+    template <typename PayloadWriter>
+    bool try_enqueue_with(const JobMsgHeader& header, PayloadWriter&& write_payload)
+    {
+        {
+            std::lock_guard guard(_lock);
+
+            const auto frame = _queue.reserve(sizeof(header) + header.payload_length);
+            if (!frame)
+                return false;
+
+            std::memcpy(frame->data(), &header, sizeof(header));
+            write_payload(reinterpret_cast<char*>(frame->data() + sizeof(header)));
+            _queue.commit(frame->size());
+        }
+
+        _event.set();
+        return true;
+    }
+
+    /// Waits on the event until a frame is available, with `_lock` released while waiting.
+    auto wait_frame(std::unique_lock<std::mutex>& guard) -> Frame
+    {
+        // 일감 없으면
+        auto frame = _queue.peek();
+        while (!frame)
+        {
+            // 메시지큐 락 해제 후 이벤트 대기
+            guard.unlock();
+            _event.wait();
+            // 다시 락 얻고 재시도
+            guard.lock();
+            frame = _queue.peek();
+        }
+
+        // 일감이 있고, 내가 메시지큐 락을 소유하니, 내가 꺼내 처리할 준비
+        return *frame;
+    }
+
+    static auto read_header(Frame frame) -> JobMsgHeader
+    {
+        JobMsgHeader header;
+        std::memcpy(&header, frame.data(), sizeof(header));
+        return header;
+    }
+
+    static auto payload_of(Frame frame, const JobMsgHeader& header) -> std::string_view
+    {
+        return std::string_view(reinterpret_cast<const char*>(frame.data() + sizeof(header)), header.payload_length);
+    }
+
+private:
+    FrameRingBuffer<Buffer> _queue;
+    std::mutex _lock;
+    cxxstd::auto_reset_event _event;
+};
+
+using RingJobQueue = BasicRingJobQueue<nb::RingByteBuffer<>>;
+using MirroredRingJobQueue = BasicRingJobQueue<MirroredRingBuffer>;
+
+/// Job queue of fixed-size `JobMsg` slots in a lock-free `MpmcBoundedQueue`.
+/// Workers only take the event path when the queue is observed empty.
+class MpmcJobQueue : public BoundedJobQueue<MpmcJobQueue>
+{
+    friend class BoundedJobQueue<MpmcJobQueue>;
+
+public:
+    /// @param capacity number of `JobMsg` slots, must be a power of 2
+    explicit MpmcJobQueue(std::size_t capacity) : _queue(capacity)
+    {
+    }
+
+    /// The payload view points into the queue slot, and is valid only inside `read`.
+    template <typename Reader>
+    void pop_with(Reader&& read)
+    {
+        auto read_slot = [&read](const JobMsg& msg) { read(msg.header, msg.payload_view()); };
+
+        while (!_queue.try_pop_with(read_slot))
+            _event.wait();
+
+        // 일감이 더 남았으면, 다른 워커도 깨움
+        if (_queue.size_approx())
+            _event.set();
+
+        _backpressure.popped();
+    }
+
+    void pop(JobMsg& msg)
+    {
+        pop_with([&msg](const JobMsgHeader& header, std::string_view payload) { msg.assign(header, payload); });
+    }
+
+    /// Blocks until a message is available, then pops up to `policy.batch_size()` messages into `batch`
+    /// on a single wakeup. The batch ends early right after a `QUIT`.
+    void pop_batch(JobBatch& batch, const BatchPolicy& policy)
+    {
+        auto pop_into = [&batch](const JobMsg& queued) {
+            batch.msgs[batch.count++].assign(queued.header, queued.payload_view());
+        };
+
+        batch.count = 0;
+        while (!_queue.try_pop_with(pop_into))
+            _event.wait();
+
+        const std::size_t batch_size = std::min(policy.batch_size(_queue.size_approx() + 1), batch.msgs.size());
+        while (batch.count < batch_size && JobMsgType::QUIT != batch.msgs[batch.count - 1].header.type)
+            if (!_queue.try_pop_with(pop_into))
+                break;
+
+        if (_queue.size_approx())
+            _event.set();
+
+        _backpressure.popped(batch.count);
+    }
+
+    void notify()
+    {
+        _event.set();
+    }
+
+private:
+    template <typename PayloadWriter>
+    bool try_enqueue_with(const JobMsgHeader& header, PayloadWriter&& write_payload)
+    {
+        const bool pushed = _queue.try_push_with([&](JobMsg& msg) {
+            msg.header = header;
+            write_payload(msg.payload);
+        });
+
+        if (pushed)
+            _event.set();
+        return pushed;
+    }
+
+private:
+    MpmcBoundedQueue<JobMsg> _queue;
+    cxxstd::auto_reset_event _event;
+};
+
+/// What a worker pops jobs from.
+/// Shared queues are popped directly; schedulers with per-worker state overload this.
+template <typename JobQueue>
+auto job_consumer(JobQueue& queue, int /* worker_id */) -> JobQueue&
+{
+    return queue;
+}
+
+} // namespace vtp
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "JobMsg.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vtp
+{
+
+/// Which lock on `Context::lock` a job handler runs under.
+enum class JobLockMode
+{
+    NONE, // the handler is thread-safe by itself, e.g. on a lock-free container
+    SHARED,
+    EXCLUSIVE,
+};
+
+/// Payload layouts for `JobRegistry` handlers.
+/// Each one tells the encoder the payload length and how to write it, and decodes it back for the handler.
+///
+/// `NoPayload` jobs carry nothing, and their handlers take no payload argument.
+struct NoPayload
+{
+};
+
+/// Variable-length string, up to `MAX_JOB_PAYLOAD_LENGTH` bytes.
+/// Encoded either from a `std::string_view`, or from `(length, fill(char* dest))` writing in place.
+struct StringPayload
+{
+    static auto length(std::string_view str) -> std::size_t
+    {
+        return str.size();
+    }
+
+    static void write(char* dest, std::string_view str)
+    {
+        str.copy(dest, str.size());
+    }
+
+    template <typename Fill>
+        requires std::is_invocable_v<Fill&, char*>
+    static auto length(std::size_t length, Fill&&) -> std::size_t
+    {
+        return length;
+    }
+
+    template <typename Fill>
+        requires std::is_invocable_v<Fill&, char*>
+    static void write(char* dest, std::size_t, Fill& fill)
+    {
+        fill(dest);
+    }
+
+    static auto read(std::string_view payload) -> std::string_view
+    {
+        return payload;
+    }
+};
+
+/// Fixed-size, trivially copyable value.
+template <typename T>
+    requires std::is_trivially_copyable_v<T> && (sizeof(T) <= MAX_JOB_PAYLOAD_LENGTH)
+struct PodPayload
+{
+    static constexpr auto length(const T&) -> std::size_t
+    {
+        return sizeof(T);
+    }
+
+    static void write(char* dest, const T& value)
+    {
+        std::memcpy(dest, &value, sizeof(T));
+    }
+
+    static auto read(std::string_view payload) -> T
+    {
+        assert(payload.size() == sizeof(T));
+
+        T value;
+        std::memcpy(&value, payload.data(), sizeof(T));
+        return value;
+    }
+};
+
+/// Header of an encoded job, plus a writer for `try_push_with()`/`push_with_for()`.
+template <typename PayloadWriter>
+struct EncodedJob
+{
+    JobMsgHeader header;
+    PayloadWriter write_payload;
+};
+
+/// Compile-time registry of job handlers.
+///
+/// Each handler is a struct declaring:
+/// - `static constexpr JobMsgType type`
+/// - `static constexpr JobLockMode lock_mode`
+/// - `static constexpr JobLane lane`, for `LaneJobQueue`
+/// - `using Payload = NoPayload / StringPayload / PodPayload<T>`
+/// - `static void handle(Context&)`, or `static void handle(Context&, <decoded payload>)`
+///
+/// From these, it generates the encoder, the decoder and a jump table indexed by `JobMsgType`,
+/// and takes the declared lock on `Context::lock` (only required if some handler locks).
+template <typename... Handlers>
+class JobRegistry
+{
+private:
+    static constexpr std::size_t TABLE_SIZE = static_cast<std::size_t>(JobMsgType::QUIT);
+
+    static constexpr bool types_are_valid()
+    {
+        std::array<bool, TABLE_SIZE> seen{};
+        for (const JobMsgType type : {Handlers::type...})
+        {
+            const auto index = static_cast<std::size_t>(type);
+            if (index >= TABLE_SIZE || seen[index])
+                return false;
+            seen[index] = true;
+        }
+        return true;
+    }
+
+    static_assert(types_are_valid(), "Job handler types must be unique, and not `QUIT`");
+
+public:
+    template <typename Handler>
+    static constexpr bool has_payload_v = !std::is_same_v<typename Handler::Payload, NoPayload>;
+
+    static constexpr bool has_payload(JobMsgType type)
+    {
+        constexpr auto table = [] {
+            std::array<bool, TABLE_SIZE> table{};
+            ((table[static_cast<std::size_t>(Handlers::type)] = has_payload_v<Handlers>), ...);
+            return table;
+        }();
+
+        const auto index = static_cast<std::size_t>(type);
+        return index < TABLE_SIZE && table[index];
+    }
+
+    /// Lane of each registered job type for `LaneJobQueue`; `QUIT` goes to `CONTROL`.
+    static constexpr auto lane_map() -> std::array<JobLane, JOB_MSG_TYPE_COUNT>
+    {
+        std::array<JobLane, JOB_MSG_TYPE_COUNT> lanes;
+        lanes.fill(JobLane::BULK);
+        ((lanes[static_cast<std::size_t>(Handlers::type)] = Handlers::lane), ...);
+        lanes[static_cast<std::size_t>(JobMsgType::QUIT)] = JobLane::CONTROL;
+        return lanes;
+    }
+
+    /// Encodes a `Handler` job from its payload arguments, e.g. `encode<ListFind>(str)`.
+    /// The returned writer keeps copies of `args`, so it's valid as long as what they point to.
+    template <typename Handler, typename... Args>
+    static auto encode(Args&&... args)
+    {
+        using Payload = typename Handler::Payload;
+
+        if constexpr (has_payload_v<Handler>)
+        {
+            const std::size_t length = Payload::length(args...);
+            if (length > MAX_JOB_PAYLOAD_LENGTH)
+                throw std::length_error("Job payload too long");
+
+            const JobMsgHeader header{Handler::type, static_cast<decltype(JobMsgHeader::payload_length)>(length)};
+            return EncodedJob{header, [... args = std::forward<Args>(args)](char* dest) mutable {
+                                  Payload::write(dest, args...);
+                              }};
+        }
+        else
+        {
+            static_assert(sizeof...(Args) == 0, "This job has no payload");
+            return EncodedJob{JobMsgHeader{Handler::type, 0}, [](char*) {}};
+        }
+    }
+
+    /// Decodes the payload and runs the handler registered for `header.type` through the jump table.
+    template <typename Context>
+    static void dispatch(Context& context, const JobMsgHeader& header, std::string_view payload)
+    {
+        using Entry = void (*)(Context&, std::string_view);
+        constexpr auto table = [] {
+            std::array<Entry, TABLE_SIZE> table{};
+            ((table[static_cast<std::size_t>(Handlers::type)] = &invoke<Handlers, Context>), ...);
+            return table;
+        }();
+
+        const auto index = static_cast<std::size_t>(header.type);
+        if (index >= TABLE_SIZE || !table[index])
+            throw std::logic_error("Unregistered job type");
+
+        table[index](context, payload);
+    }
+
+    /// Calls `func.template operator()<Handler>()` with the handler registered for `type`.
+    /// @return `false` if none is registered
+    template <typename Func>
+    static bool visit(JobMsgType type, Func&& func)
+    {
+        return ((Handlers::type == type ? (func.template operator()<Handlers>(), true) : false) || ...);
+    }
+
+private:
+    template <typename Handler, typename Context>
+    static void invoke(Context& context, std::string_view payload)
+    {
+        if constexpr (JobLockMode::SHARED == Handler::lock_mode)
+        {
+            std::shared_lock guard(context.lock);
+            decode_and_handle<Handler>(context, payload);
+        }
+        else if constexpr (JobLockMode::EXCLUSIVE == Handler::lock_mode)
+        {
+            std::unique_lock guard(context.lock);
+            decode_and_handle<Handler>(context, payload);
+        }
+        else
+        {
+            decode_and_handle<Handler>(context, payload);
+        }
+    }
+
+    template <typename Handler, typename Context>
+    static void decode_and_handle(Context& context, std::string_view payload)
+    {
+        if constexpr (has_payload_v<Handler>)
+            Handler::handle(context, Handler::Payload::read(payload));
+        else
+            Handler::handle(context);
+    }
+};
+
+} // namespace vtp
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "JobClock.hpp"
+#include "JobMsg.hpp"
+
+#include <vtp/HdrHistogram.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <string>
+
+namespace vtp
+{
+
+/// Queue-wait (push to dequeue) and service (dequeue to done) times of one worker's jobs, for each `JobMsgType`.
+/// Only its worker records into it, so recording never contends with other workers.
+class JobTrace
+{
+public:
+    /// @param enqueued `JobMsgHeader::enqueued`
+    /// @param started `JobClock::now()` when the worker started on this job
+    /// @param finished `JobClock::now()` when it was done
+    void record(JobMsgType type, std::uint64_t enqueued, std::uint64_t started, std::uint64_t finished)
+    {
+        const auto index = static_cast<std::size_t>(type);
+        _queue_wait[index].record(JobClock::elapsed_ns(enqueued, started));
+        _service[index].record(JobClock::elapsed_ns(started, finished));
+    }
+
+    auto queue_wait(JobMsgType type) const -> const HdrHistogram&
+    {
+        return _queue_wait[static_cast<std::size_t>(type)];
+    }
+
+    auto service(JobMsgType type) const -> const HdrHistogram&
+    {
+        return _service[static_cast<std::size_t>(type)];
+    }
+
+private:
+    std::array<HdrHistogram, JOB_MSG_TYPE_COUNT> _queue_wait;
+    std::array<HdrHistogram, JOB_MSG_TYPE_COUNT> _service;
+};
+
+/// `JobTrace` for each worker, merged into a per-type table on `dump()`.
+/// `dump()` can run anytime, alongside the workers recording.
+class JobTracer
+{
+public:
+    explicit JobTracer(int workers) : _workers(workers), _traces(std::make_unique<JobTrace[]>(workers))
+    {
+        // 첫 `record()` 중에 워커가 보정하느라 멈추지 않도록, 미리 보정
+        JobClock::calibrate();
+    }
+
+public:
+    auto worker(int worker_id) -> JobTrace&
+    {
+        return _traces[worker_id];
+    }
+
+    /// Queue-wait and service time percentiles so far, in microseconds, of every job type seen.
+    auto dump() const -> std::string
+    {
+        std::string table;
+        auto out = std::back_inserter(table);
+        std::format_to(out, "{:>14} | {:>9} | {:>9} | {:>9} | {:>9} | {:>9} | {:>9} | {:>9}\n", "job (us)", "count",
+                       "wait p50", "wait p99", "wait max", "run p50", "run p99", "run max");
+
+        for (std::size_t i = 0; i < JOB_MSG_TYPE_COUNT; ++i)
+        {
+            const auto type = static_cast<JobMsgType>(i);
+
+            HdrHistogram queue_wait, service;
+            for (int w = 0; w < _workers; ++w)
+            {
+                queue_wait.merge(_traces[w].queue_wait(type));
+                service.merge(_traces[w].service(type));
+            }
+            if (0 == queue_wait.count())
+                continue;
+
+            std::format_to(out, "{:>14} | {:>9} | {:>9.1f} | {:>9.1f} | {:>9.1f} | {:>9.1f} | {:>9.1f} | {:>9.1f}\n",
+                           to_string(type), queue_wait.count(), queue_wait.percentile(50) / 1e3,
+                           queue_wait.percentile(99) / 1e3, queue_wait.max() / 1e3, service.percentile(50) / 1e3,
+                           service.percentile(99) / 1e3, service.max() / 1e3);
+        }
+        return table;
+    }
+
+private:
+    const int _workers;
+    const std::unique_ptr<JobTrace[]> _traces;
+};
+
+} // namespace vtp
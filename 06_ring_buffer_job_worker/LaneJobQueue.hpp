@@ -0,0 +1,250 @@
+#pragma once
+
+#include "JobMsg.hpp"
+#include "MpmcBoundedQueue.hpp"
+#include "QueueBackpressure.hpp"
+#include "auto_reset_event_cxxstd.hpp"
+
+#include <vtp/HdrHistogram.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vtp
+{
+
+/// Which lane each `JobMsgType` is queued in, indexed by the type.
+using JobLaneMap = std::array<JobLane, JOB_MSG_TYPE_COUNT>;
+
+/// Share of the pops each non-control lane gets while all of them are busy.
+struct JobLaneWeights
+{
+    std::uint32_t latency = 8;
+    std::uint32_t bulk = 1;
+};
+
+/// Job queue with a bounded MPMC queue per `JobLane`, so a flood of bulk jobs can't delay the latency-sensitive ones.
+///
+/// - `CONTROL` is strict priority, except that a `QUIT` waits until the other lanes are drained.
+/// - `LATENCY` and `BULK` are popped by weighted round-robin, and an empty lane gives its turn away.
+///
+/// Each lane records its queue-wait time (push to pop) in a `HdrHistogram`.
+class LaneJobQueue : public BoundedJobQueue<LaneJobQueue>
+{
+    friend class BoundedJobQueue<LaneJobQueue>;
+
+private:
+    using LaneClock = std::chrono::steady_clock;
+
+    struct LaneSlot
+    {
+        JobMsg msg;
+        LaneClock::time_point enqueued;
+    };
+
+public:
+    /// @param lane_capacity number of `JobMsg` slots in each lane, must be a power of 2
+    LaneJobQueue(std::size_t lane_capacity, const JobLaneMap& lane_map, JobLaneWeights weights = {})
+        : _lane_map(lane_map), _schedule(make_schedule(weights))
+    {
+        for (auto& lane : _lanes)
+            lane = std::make_unique<MpmcBoundedQueue<LaneSlot>>(lane_capacity);
+    }
+
+    /// The payload view points into the lane slot, and is valid only inside `read`.
+    template <typename Reader>
+    void pop_with(Reader&& read)
+    {
+        auto read_msg = [&read](const JobMsg& msg) { read(msg.header, msg.payload_view()); };
+
+        while (!try_pop_any(read_msg))
+            wait_for_jobs();
+
+        if (size_approx())
+            _event.set();
+
+        _backpressure.popped();
+    }
+
+    void pop(JobMsg& msg)
+    {
+        pop_with([&msg](const JobMsgHeader& header, std::string_view payload) { msg.assign(header, payload); });
+    }
+
+    /// Blocks until a message is available, then pops up to `policy.batch_size()` messages into `batch`,
+    /// each picked by the lane schedule. The batch ends early right after a `QUIT`.
+    void pop_batch(JobBatch& batch, const BatchPolicy& policy)
+    {
+        auto pop_into = [&batch](const JobMsg& queued) {
+            batch.msgs[batch.count++].assign(queued.header, queued.payload_view());
+        };
+
+        batch.count = 0;
+        while (!try_pop_any(pop_into))
+            wait_for_jobs();
+
+        const std::size_t batch_size = std::min(policy.batch_size(size_approx() + 1), batch.msgs.size());
+        while (batch.count < batch_size && JobMsgType::QUIT != batch.msgs[batch.count - 1].header.type)
+            if (!try_pop_any(pop_into))
+                break;
+
+        if (size_approx())
+            _event.set();
+
+        _backpressure.popped(batch.count);
+    }
+
+    void notify()
+    {
+        _event.set();
+    }
+
+public:
+    /// Queue-wait time of the jobs popped from `lane`, in nanoseconds.
+    auto lane_wait(JobLane lane) const -> const HdrHistogram&
+    {
+        return _lane_wait[static_cast<std::size_t>(lane)];
+    }
+
+private:
+    template <typename PayloadWriter>
+    bool try_enqueue_with(const JobMsgHeader& header, PayloadWriter&& write_payload)
+    {
+        const bool pushed = lane_of(header.type).try_push_with([&](LaneSlot& slot) {
+            slot.msg.header = header;
+            write_payload(slot.msg.payload);
+            slot.enqueued = LaneClock::now();
+        });
+
+        if (pushed)
+            _event.set();
+        return pushed;
+    }
+
+    /// Pops one message with `read(const JobMsg&)`, trying the lanes in schedule order.
+    template <typename Reader>
+    bool try_pop_any(Reader& read)
+    {
+        if (try_pop_control(read))
+            return true;
+
+        const JobLane turn = _schedule[_turn.fetch_add(1, std::memory_order_relaxed) % _schedule.size()];
+        if (try_pop_lane(turn, read))
+            return true;
+        return try_pop_lane(JobLane::LATENCY == turn ? JobLane::BULK : JobLane::LATENCY, read);
+    }
+
+    template <typename Reader>
+    bool try_pop_lane(JobLane lane, Reader& read)
+    {
+        return lane_at(lane).try_pop_with([&](const LaneSlot& slot) {
+            _lane_wait[static_cast<std::size_t>(lane)].record(LaneClock::now() - slot.enqueued);
+            read(slot.msg);
+        });
+    }
+
+    /// `QUIT` must not overtake the jobs queued before it, so it's put back while the other lanes have jobs.
+    template <typename Reader>
+    bool try_pop_control(Reader& read)
+    {
+        auto& control = lane_at(JobLane::CONTROL);
+        if (0 == control.size_approx())
+            return false;
+
+        LaneSlot slot;
+        if (!control.try_pop(slot))
+            return false;
+
+        if (JobMsgType::QUIT == slot.msg.header.type && size_approx(JobLane::LATENCY) + size_approx(JobLane::BULK))
+        {
+            // 방금 비운 자리지만, 다른 생산자가 먼저 채웠을 수 있음
+            while (!control.try_push(slot))
+                std::this_thread::yield();
+            return false;
+        }
+
+        _lane_wait[static_cast<std::size_t>(JobLane::CONTROL)].record(LaneClock::now() - slot.enqueued);
+        read(slot.msg);
+        return true;
+    }
+
+    /// Sleeps only if every lane is empty; a deferred `QUIT` is retried instead.
+    void wait_for_jobs()
+    {
+        if (0 == size_approx())
+            _event.wait();
+    }
+
+    auto size_approx() const -> std::size_t
+    {
+        std::size_t size = 0;
+        for (const auto& lane : _lanes)
+            size += lane->size_approx();
+        return size;
+    }
+
+    auto size_approx(JobLane lane) const -> std::size_t
+    {
+        return _lanes[static_cast<std::size_t>(lane)]->size_approx();
+    }
+
+    auto lane_at(JobLane lane) -> MpmcBoundedQueue<LaneSlot>&
+    {
+        return *_lanes[static_cast<std::size_t>(lane)];
+    }
+
+    auto lane_of(JobMsgType type) -> MpmcBoundedQueue<LaneSlot>&
+    {
+        return lane_at(_lane_map[static_cast<std::size_t>(type)]);
+    }
+
+    /// Smooth weighted round-robin order, e.g. 2:1 gives `L B L`, instead of `L L B`.
+    static auto make_schedule(JobLaneWeights weights) -> std::vector<JobLane>
+    {
+        if (0 == weights.latency + weights.bulk)
+            throw std::invalid_argument("At least one lane weight must be non-zero");
+
+        const std::array<std::pair<JobLane, std::int64_t>, 2> lanes{{
+            {JobLane::LATENCY, weights.latency},
+            {JobLane::BULK, weights.bulk},
+        }};
+        const std::int64_t total = weights.latency + weights.bulk;
+
+        std::vector<JobLane> schedule;
+        std::array<std::int64_t, 2> current{};
+        for (std::int64_t i = 0; i < total; ++i)
+        {
+            std::size_t best = 0;
+            for (std::size_t l = 0; l < lanes.size(); ++l)
+            {
+                current[l] += lanes[l].second;
+                if (current[l] > current[best])
+                    best = l;
+            }
+            current[best] -= total;
+            schedule.push_back(lanes[best].first);
+        }
+        return schedule;
+    }
+
+private:
+    const JobLaneMap _lane_map;
+    const std::vector<JobLane> _schedule;
+
+    std::array<std::unique_ptr<MpmcBoundedQueue<LaneSlot>>, JOB_LANE_COUNT> _lanes;
+    std::array<HdrHistogram, JOB_LANE_COUNT> _lane_wait;
+
+    std::atomic<std::uint64_t> _turn = 0;
+    cxxstd::auto_reset_event _event;
+};
+
+} // namespace vtp
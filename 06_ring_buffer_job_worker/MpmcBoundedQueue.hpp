@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace vtp
+{
+
+/// Bounded MPMC queue by Dmitry Vyukov
+/// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+///
+/// Each cell has its own sequence number, so producers and consumers only contend on
+/// `_enqueue_pos` / `_dequeue_pos` (kept on separate cache lines), never on a lock.
+template <typename T>
+    requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class MpmcBoundedQueue
+{
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    struct alignas(CACHE_LINE_SIZE) Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    static_assert(std::atomic<std::size_t>::is_always_lock_free);
+
+public:
+    /// @param capacity must be a power of 2
+    explicit MpmcBoundedQueue(std::size_t capacity)
+        : _cells(std::make_unique<Cell[]>(check_capacity(capacity))), _mask(capacity - 1)
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcBoundedQueue(const MpmcBoundedQueue&) = delete;
+    MpmcBoundedQueue& operator=(const MpmcBoundedQueue&) = delete;
+
+public: // Capacity
+    auto capacity() const noexcept -> std::size_t
+    {
+        return _mask + 1;
+    }
+
+    /// Approximate, as other threads might be pushing or popping concurrently.
+    auto size_approx() const noexcept -> std::size_t
+    {
+        const auto enqueue_pos = _enqueue_pos.load(std::memory_order_relaxed);
+        const auto dequeue_pos = _dequeue_pos.load(std::memory_order_relaxed);
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+public: // Modifiers
+    bool try_push(const T& value)
+    {
+        return try_push_with([&value](T& data) { data = value; });
+    }
+
+    bool try_pop(T& value)
+    {
+        return try_pop_with([&value](const T& data) { value = data; });
+    }
+
+    /// Claims a cell and lets `write(T&)` construct the element in place.
+    /// @return `false` if the queue was full
+    template <typename Writer>
+    bool try_push_with(Writer&& write)
+    {
+        Cell* cell;
+        std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &_cells[pos & _mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (0 == diff)
+            {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) // full
+                return false;
+            else
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+
+        write(cell->data);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Claims the oldest cell and lets `read(const T&)` consume the element in place.
+    /// @return `false` if the queue was empty
+    template <typename Reader>
+    bool try_pop_with(Reader&& read)
+    {
+        Cell* cell;
+        std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &_cells[pos & _mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (0 == diff)
+            {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) // empty
+                return false;
+            else
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+        }
+
+        read(std::as_const(cell->data));
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static auto check_capacity(std::size_t capacity) -> std::size_t
+    {
+        if (capacity < 2 || (capacity & (capacity - 1)))
+            throw std::invalid_argument("MpmcBoundedQueue capacity must be a power of 2");
+        return capacity;
+    }
+
+private:
+    const std::unique_ptr<Cell[]> _cells;
+    const std::size_t _mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _enqueue_pos = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _dequeue_pos = 0;
+};
+
+} // namespace vtp
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "JobClock.hpp"
+#include "JobMsg.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+namespace vtp
+{
+
+enum class PushStatus
+{
+    OK,
+    QUEUE_FULL, // non-blocking push failed
+    TIMED_OUT,  // blocking push failed, the queue stayed full until the deadline
+};
+
+/// Snapshot of a job queue's backpressure metrics.
+struct QueueMetrics
+{
+    std::size_t depth = 0;                   // messages currently queued
+    std::size_t max_depth = 0;               // high-water mark of `depth`
+    std::uint64_t rejected = 0;              // `try_push*()` returned `QUEUE_FULL`
+    std::uint64_t blocked = 0;               // `push*_for()` had to wait for space
+    std::uint64_t timed_out = 0;             // `push*_for()` returned `TIMED_OUT`
+    std::chrono::nanoseconds blocked_time{}; // total time producers spent waiting for space
+};
+
+/// High/low watermarks on the queue depth, counted in messages.
+///
+/// `on_high` is called once the depth reaches `high`, and `on_low` once it drops back to `low`,
+/// so producers can shed or slow down in between.
+/// Callbacks run on the pushing or popping thread, outside of the queue lock;
+/// keep them short, and don't push from them.
+struct QueueWatermarks
+{
+    std::size_t high = std::numeric_limits<std::size_t>::max();
+    std::size_t low = 0;
+    std::function<void(std::size_t depth)> on_high;
+    std::function<void(std::size_t depth)> on_low;
+};
+
+/// Bounded-queue semantics shared by the job queues:
+/// depth accounting, watermark callbacks, metrics, and parking producers while the queue is full.
+///
+/// The queue calls `pushed()`/`popped()` after a successful push/pop, outside of its own lock.
+class QueueBackpressure
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    /// Not thread-safe; set before pushing.
+    void set_watermarks(QueueWatermarks watermarks)
+    {
+        _watermarks = std::move(watermarks);
+    }
+
+    /// Approximate, as the depth is updated after the queue lock is released.
+    auto depth() const -> std::size_t
+    {
+        const auto depth = _depth.load(std::memory_order_relaxed);
+        return depth > 0 ? static_cast<std::size_t>(depth) : 0;
+    }
+
+    auto metrics() const -> QueueMetrics
+    {
+        QueueMetrics metrics;
+        metrics.depth = depth();
+        metrics.max_depth = static_cast<std::size_t>(_max_depth.load(std::memory_order_relaxed));
+        metrics.rejected = _rejected.load(std::memory_order_relaxed);
+        metrics.blocked = _blocked.load(std::memory_order_relaxed);
+        metrics.timed_out = _timed_out.load(std::memory_order_relaxed);
+        metrics.blocked_time = std::chrono::nanoseconds(_blocked_ns.load(std::memory_order_relaxed));
+        return metrics;
+    }
+
+public:
+    /// Wraps a single non-blocking push attempt.
+    template <typename TryPush>
+    auto try_push(TryPush&& attempt) -> PushStatus
+    {
+        if (attempt())
+        {
+            pushed();
+            return PushStatus::OK;
+        }
+
+        _rejected.fetch_add(1, std::memory_order_relaxed);
+        return PushStatus::QUEUE_FULL;
+    }
+
+    /// Retries `attempt()` whenever a consumer frees up space, until it succeeds or `timeout` passes.
+    template <typename TryPush>
+    auto push_for(TryPush&& attempt, Clock::duration timeout) -> PushStatus
+    {
+        if (attempt())
+        {
+            pushed();
+            return PushStatus::OK;
+        }
+
+        const auto started = Clock::now();
+        const auto deadline = started + timeout;
+        bool ok = false;
+        {
+            std::unique_lock guard(_space_lock);
+            // 소비자가 `popped()` 에서 이걸 보고 깨워줌
+            _waiting_producers.fetch_add(1);
+
+            // 락 없는 큐에선 소비자가 자리를 비운 release store 와 재시도의 acquire load 사이에 순서가 없어,
+            // 양쪽이 서로의 옛 값을 볼 수 있음 (store buffer). `popped()` 의 fence 와 짝을 이뤄서,
+            // 소비자가 이 카운터를 보고 깨우거나, 아래 재시도가 빈 자리를 보거나 둘 중 하나는 보장됨.
+            // 깨우기는 `_space_lock` 아래서 하니, 재시도와 대기 사이에 온 알림도 놓치지 않음
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!(ok = attempt()))
+            {
+                if (std::cv_status::timeout == _space_cv.wait_until(guard, deadline))
+                {
+                    ok = attempt();
+                    break;
+                }
+            }
+
+            _waiting_producers.fetch_sub(1);
+        }
+
+        const auto blocked_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+        _blocked.fetch_add(1, std::memory_order_relaxed);
+        _blocked_ns.fetch_add(blocked_ns.count(), std::memory_order_relaxed);
+
+        if (!ok)
+        {
+            _timed_out.fetch_add(1, std::memory_order_relaxed);
+            return PushStatus::TIMED_OUT;
+        }
+
+        pushed();
+        return PushStatus::OK;
+    }
+
+    /// Called by the queue after `count` messages are popped.
+    void popped(std::size_t count = 1)
+    {
+        const auto depth = _depth.fetch_sub(static_cast<std::int64_t>(count), std::memory_order_relaxed) -
+                           static_cast<std::int64_t>(count);
+
+        if (depth <= static_cast<std::int64_t>(_watermarks.low) && _above_high.load(std::memory_order_relaxed) &&
+            _above_high.exchange(false, std::memory_order_relaxed) && _watermarks.on_low)
+        {
+            _watermarks.on_low(depth > 0 ? static_cast<std::size_t>(depth) : 0);
+        }
+
+        // 공간이 났으니 막혀있는 생산자 깨움
+        // (자리를 비운 큐의 store 가 카운터 load 보다 먼저 보이게: `push_for()` 의 fence 와 짝)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiting_producers.load())
+        {
+            std::lock_guard guard(_space_lock);
+            _space_cv.notify_all();
+        }
+    }
+
+private:
+    void pushed()
+    {
+        const auto depth = _depth.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        auto max_depth = _max_depth.load(std::memory_order_relaxed);
+        while (depth > max_depth && !_max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed))
+            ;
+
+        if (depth >= static_cast<std::int64_t>(_watermarks.high) && !_above_high.load(std::memory_order_relaxed) &&
+            !_above_high.exchange(true, std::memory_order_relaxed) && _watermarks.on_high)
+        {
+            _watermarks.on_high(static_cast<std::size_t>(depth));
+        }
+    }
+
+private:
+    QueueWatermarks _watermarks;
+
+    // signed, as a consumer might `popped()` before the producer gets to `pushed()`
+    std::atomic<std::int64_t> _depth = 0;
+    std::atomic<std::int64_t> _max_depth = 0;
+    std::atomic<bool> _above_high = false;
+
+    std::atomic<std::uint64_t> _rejected = 0;
+    std::atomic<std::uint64_t> _blocked = 0;
+    std::atomic<std::uint64_t> _timed_out = 0;
+    std::atomic<std::int64_t> _blocked_ns = 0;
+
+    std::mutex _space_lock;
+    std::condition_variable _space_cv;
+    std::atomic<int> _waiting_producers = 0;
+};
+
+/// Producer side shared by the job queues, built on the derived queue's
+/// `bool try_enqueue_with(const JobMsgHeader&, PayloadWriter&&)`, a single non-blocking attempt.
+///
+/// The derived queue calls `_backpressure.popped()` after popping.
+template <typename Derived>
+class BoundedJobQueue
+{
+public:
+    using Clock = QueueBackpressure::Clock;
+
+public:
+    /// Non-blocking push.
+    /// `write_payload(char*)` writes `header.payload_length` bytes directly into the queue.
+    template <typename PayloadWriter>
+    auto try_push_with(const JobMsgHeader& header, PayloadWriter&& write_payload) -> PushStatus
+    {
+        return _backpressure.try_push([&]() { return try_enqueue(header, write_payload); });
+    }
+
+    auto try_push(const JobMsgHeader& header, const void* payload) -> PushStatus
+    {
+        return try_push_with(header, copy_payload(header, payload));
+    }
+
+    /// Blocks while the queue is full, for up to `timeout`.
+    template <typename PayloadWriter>
+    auto push_with_for(const JobMsgHeader& header, PayloadWriter&& write_payload, Clock::duration timeout)
+        -> PushStatus
+    {
+        return _backpressure.push_for([&]() { return try_enqueue(header, write_payload); },
+                                      timeout);
+    }
+
+    auto push_for(const JobMsgHeader& header, const void* payload, Clock::duration timeout) -> PushStatus
+    {
+        return push_with_for(header, copy_payload(header, payload), timeout);
+    }
+
+    /// Not thread-safe; set before pushing.
+    void set_watermarks(QueueWatermarks watermarks)
+    {
+        _backpressure.set_watermarks(std::move(watermarks));
+    }
+
+    auto metrics() const -> QueueMetrics
+    {
+        return _backpressure.metrics();
+    }
+
+private:
+    auto derived() -> Derived&
+    {
+        return static_cast<Derived&>(*this);
+    }
+
+    template <typename PayloadWriter>
+    bool try_enqueue(const JobMsgHeader& header, PayloadWriter& write_payload)
+    {
+#if defined(VTP_JOB_TRACING)
+        // 막혀 기다린 시간은 빼고, 실제로 큐에 들어간 시각을 찍도록 매 시도마다 새로
+        JobMsgHeader stamped = header;
+        stamped.enqueued = JobClock::now();
+        return derived().try_enqueue_with(stamped, write_payload);
+#else
+        return derived().try_enqueue_with(header, write_payload);
+#endif
+    }
+
+    static auto copy_payload(const JobMsgHeader& header, const void* payload)
+    {
+        return [&header, payload](char* dest) {
+            if (header.payload_length)
+                std::memcpy(dest, payload, header.payload_length);
+        };
+    }
+
+protected:
+    QueueBackpressure _backpressure;
+};
+
+} // namespace vtp
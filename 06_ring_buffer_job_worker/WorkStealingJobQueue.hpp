@@ -0,0 +1,270 @@
+#pragma once
+
+#include "ChaseLevDeque.hpp"
+#include "JobMsg.hpp"
+#include "MpmcBoundedQueue.hpp"
+#include "QueueBackpressure.hpp"
+#include "auto_reset_event_cxxstd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <thread>
+
+namespace vtp
+{
+
+/// Work-stealing job scheduler.
+///
+/// Job messages live in a preallocated slot pool, and only their 32-bit slot indices move around:
+/// the producer pushes into a global injection queue, each worker moves a batch of them into its own
+/// Chase-Lev deque, and idle workers steal from a randomly chosen victim before going to sleep.
+class WorkStealingJobQueue : public BoundedJobQueue<WorkStealingJobQueue>
+{
+    friend class BoundedJobQueue<WorkStealingJobQueue>;
+
+private:
+    using SlotIndex = std::uint32_t;
+
+    /// Max jobs moved from the injection queue into a worker's deque at once.
+    static constexpr int INJECTION_BATCH = 8;
+
+public:
+    struct WorkerStats
+    {
+        std::uint64_t popped_local = 0;
+        std::uint64_t popped_injected = 0;
+        std::uint64_t steals = 0;
+        std::uint64_t failed_steals = 0;
+        std::chrono::steady_clock::duration idle_time{};
+    };
+
+    class Worker
+    {
+        friend class WorkStealingJobQueue;
+
+    public:
+        Worker(WorkStealingJobQueue& scheduler, int id, std::size_t deque_capacity)
+            : _scheduler(scheduler), _id(id), _deque(deque_capacity), _rng(static_cast<unsigned>(id) + 1)
+        {
+        }
+
+        /// Blocks until a job is available, then pops it with `read(const JobMsgHeader&, std::string_view)`.
+        template <typename Reader>
+        void pop_with(Reader&& read)
+        {
+            const SlotIndex index = acquire();
+            const JobMsg& msg = _scheduler._slots[index];
+            read(msg.header, msg.payload_view());
+            _scheduler.release(index);
+        }
+
+        void pop(JobMsg& msg)
+        {
+            pop_with([&msg](const JobMsgHeader& header, std::string_view payload) { msg.assign(header, payload); });
+        }
+
+        /// Blocks until a job is available, then pops up to `policy.batch_size()` jobs into `batch`,
+        /// taking the rest from my own deque only. The batch ends early right after a `QUIT`.
+        void pop_batch(JobBatch& batch, const BatchPolicy& policy)
+        {
+            batch.count = 0;
+            take(batch, acquire());
+
+            const std::size_t batch_size = std::min(policy.batch_size(_deque.size_approx() + 1), batch.msgs.size());
+            while (batch.count < batch_size && JobMsgType::QUIT != batch.msgs[batch.count - 1].header.type)
+            {
+                SlotIndex index;
+                if (!_deque.pop(index))
+                    break;
+                ++_stats.popped_local;
+
+                if (JobMsgType::QUIT == _scheduler._slots[index].header.type && !_deque.empty_approx())
+                {
+                    _scheduler.inject(index);
+                    continue;
+                }
+                take(batch, index);
+            }
+        }
+
+        auto stats() const -> const WorkerStats&
+        {
+            return _stats;
+        }
+
+    private:
+        void take(JobBatch& batch, SlotIndex index)
+        {
+            const JobMsg& msg = _scheduler._slots[index];
+            batch.msgs[batch.count++].assign(msg.header, msg.payload_view());
+            _scheduler.release(index);
+        }
+
+        auto acquire() -> SlotIndex
+        {
+            for (;;)
+            {
+                SlotIndex index;
+                if (_deque.pop(index))
+                    ++_stats.popped_local;
+                else if (grab_injected(index))
+                    ++_stats.popped_injected;
+                else if (steal(index))
+                    ++_stats.steals;
+                else
+                {
+                    const auto idle_started = std::chrono::steady_clock::now();
+                    _scheduler._event.wait();
+                    _stats.idle_time += std::chrono::steady_clock::now() - idle_started;
+                    continue;
+                }
+
+                // 로컬 일감이 남아있으면 QUIT 은 받지 않고 다른 워커에게 넘김
+                if (JobMsgType::QUIT == _scheduler._slots[index].header.type && !_deque.empty_approx())
+                {
+                    _scheduler.inject(index);
+                    continue;
+                }
+                return index;
+            }
+        }
+
+        /// Takes one job from the injection queue, and moves a few more into my deque for others to steal.
+        bool grab_injected(SlotIndex& index)
+        {
+            if (!_scheduler._injection.try_pop(index))
+                return false;
+
+            int moved = 0;
+            SlotIndex extra;
+            while (moved < INJECTION_BATCH - 1 && _scheduler._injection.try_pop(extra))
+            {
+                if (!_deque.push(extra))
+                {
+                    _scheduler.inject(extra);
+                    break;
+                }
+                ++moved;
+            }
+
+            // 내 덱에 옮겨둔 일감은 자고 있는 워커가 훔쳐가도록 깨움
+            if (moved)
+                _scheduler._event.set();
+            return true;
+        }
+
+        /// Tries every other worker once, starting from a random victim.
+        bool steal(SlotIndex& index)
+        {
+            const int workers = static_cast<int>(_scheduler._workers.size());
+            if (workers < 2)
+                return false;
+
+            const int start = std::uniform_int_distribution<int>(0, workers - 1)(_rng);
+            for (int i = 0; i < workers; ++i)
+            {
+                const int victim = (start + i) % workers;
+                if (victim == _id)
+                    continue;
+
+                if (_scheduler._workers[victim]._deque.steal(index))
+                    return true;
+                ++_stats.failed_steals;
+            }
+            return false;
+        }
+
+    private:
+        WorkStealingJobQueue& _scheduler;
+        const int _id;
+        ChaseLevDeque<SlotIndex> _deque;
+        std::minstd_rand _rng;
+        WorkerStats _stats;
+    };
+
+public:
+    /// @param capacity number of job slots, must be a power of 2
+    WorkStealingJobQueue(std::size_t capacity, int workers)
+        : _slots(std::make_unique<JobMsg[]>(capacity)), _free_slots(capacity), _injection(capacity)
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+            _free_slots.try_push(static_cast<SlotIndex>(i));
+
+        for (int i = 0; i < workers; ++i)
+            _workers.emplace_back(*this, i, capacity);
+    }
+
+    WorkStealingJobQueue(const WorkStealingJobQueue&) = delete;
+    WorkStealingJobQueue& operator=(const WorkStealingJobQueue&) = delete;
+
+public:
+    auto worker(int id) -> Worker&
+    {
+        return _workers[id];
+    }
+
+    void notify()
+    {
+        _event.set();
+    }
+
+private:
+    template <typename PayloadWriter>
+    bool try_enqueue_with(const JobMsgHeader& header, PayloadWriter&& write_payload)
+    {
+        SlotIndex index;
+        if (!_free_slots.try_pop(index))
+            return false;
+
+        JobMsg& msg = _slots[index];
+        msg.header = header;
+        write_payload(msg.payload);
+
+        inject(index);
+        return true;
+    }
+
+    void inject(SlotIndex index)
+    {
+        push_index(_injection, index);
+        _event.set();
+    }
+
+    void release(SlotIndex index)
+    {
+        push_index(_free_slots, index);
+        _backpressure.popped();
+    }
+
+    /// Pushes into a queue as large as the slot pool, so it's never really full.
+    /// But `try_push()` still fails while a consumer that claimed the cell next in line hasn't finished reading it,
+    /// so retry until it has, rather than drop the slot.
+    static void push_index(MpmcBoundedQueue<SlotIndex>& queue, SlotIndex index)
+    {
+        while (!queue.try_push(index))
+            std::this_thread::yield();
+    }
+
+private:
+    const std::unique_ptr<JobMsg[]> _slots;
+    MpmcBoundedQueue<SlotIndex> _free_slots;
+    MpmcBoundedQueue<SlotIndex> _injection;
+
+    // `std::deque` never relocates its elements on `emplace_back()`
+    std::deque<Worker> _workers;
+
+    cxxstd::auto_reset_event _event;
+};
+
+inline auto job_consumer(WorkStealingJobQueue& queue, int worker_id) -> WorkStealingJobQueue::Worker&
+{
+    return queue.worker(worker_id);
+}
+
+} // namespace vtp
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace vtp::cxxstd
+{
+
+/// Auto-reset event (like `CreateEvent(nullptr, false, false, nullptr)`)
+/// implemented with `std::atomic::wait()`, which is a futex on Linux and `WaitOnAddress()` on Windows.
+class auto_reset_event
+{
+    static_assert(__cplusplus >= 202002L, "Use C++20 or higher");
+
+private:
+    std::atomic<std::uint32_t> _signaled = 0;
+
+    static_assert(decltype(_signaled)::is_always_lock_free);
+
+public:
+    /// Signals the event.
+    /// Signaling an already signaled event does nothing, just like `SetEvent()`.
+    void set()
+    {
+        if (0 == _signaled.exchange(1, std::memory_order_release))
+            _signaled.notify_one();
+    }
+
+    /// Waits until the event is signaled, then resets it.
+    void wait()
+    {
+        for (;;)
+        {
+            std::uint32_t expected = 1;
+            if (_signaled.compare_exchange_weak(expected, 0, std::memory_order_acquire, std::memory_order_relaxed))
+                break;
+
+            if (0 == expected)
+                _signaled.wait(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace vtp::cxxstd
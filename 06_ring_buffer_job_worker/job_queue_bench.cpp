@@ -0,0 +1,489 @@
+#include "JobMsg.hpp"
+#include "JobQueue.hpp"
+#include "JobRegistry.hpp"
+#include "LaneJobQueue.hpp"
+#include "WorkStealingJobQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <vtp/HdrHistogram.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+using vtp::JobMsgHeader;
+using vtp::JobMsgType;
+
+static constexpr int DEFAULT_MESSAGES = 1'000'000;
+static constexpr int WORKER_COUNTS[] = {1, 3, 16, 64};
+
+static constexpr int RING_BUFFER_SIZE = 50'000;
+static constexpr int MPMC_QUEUE_SLOTS = 4096;
+
+// max batch size for the batched dequeue runs
+static constexpr std::size_t MAX_BATCH = 32;
+
+static constexpr auto PUSH_TIMEOUT = std::chrono::milliseconds(100);
+
+// priority lanes run: 1 latency-sensitive job for every N bulk jobs, each bulk job keeping a worker busy this long
+static constexpr int BULK_JOBS_PER_LATENCY_JOB = 15;
+static constexpr auto BULK_SERVICE_TIME = std::chrono::microseconds(2);
+static constexpr int PRIORITY_WORKER_COUNTS[] = {1, 3, 16};
+
+// registry locks run: 1 exclusive job for every N shared ones
+static constexpr int SHARED_JOBS_PER_EXCLUSIVE_JOB = 3;
+static constexpr int REGISTRY_THREADS = 4;
+static constexpr auto SHARED_SERVICE_TIME = std::chrono::microseconds(1); // long enough for readers to overlap
+
+struct BenchResult
+{
+    double seconds;
+    std::uint64_t checksum;
+    std::uint64_t batches = 0;
+};
+
+/// One producer floods `messages` jobs into `msg_queue` (blocking while full),
+/// `workers` threads pop them and sum up their payload bytes.
+///
+/// With `max_batch` > 0, workers `pop_batch()` instead of `pop_with()`.
+template <typename JobQueue>
+auto bench(JobQueue& msg_queue, const int workers, const int messages, const std::size_t max_batch = 0)
+    -> BenchResult
+{
+    std::atomic<std::uint64_t> checksum = 0;
+    std::atomic<std::uint64_t> batches = 0;
+
+    std::atomic<bool> ready_flag = false;
+    std::vector<std::jthread> threads;
+    threads.reserve(workers);
+
+    for (int i = 0; i < workers; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            auto& consumer = vtp::job_consumer(msg_queue, i);
+            ready_flag.wait(false);
+
+            std::uint64_t sum = 0;
+            std::uint64_t popped_batches = 0;
+            bool quit = false;
+            if (max_batch)
+            {
+                const vtp::BatchPolicy policy{.max_batch = max_batch, .workers = static_cast<std::size_t>(workers)};
+                vtp::JobBatch batch(max_batch);
+                while (!quit)
+                {
+                    consumer.pop_batch(batch, policy);
+                    ++popped_batches;
+                    for (const vtp::JobMsg& msg : batch.view())
+                    {
+                        quit = (JobMsgType::QUIT == msg.header.type);
+                        for (const char ch : msg.payload_view())
+                            sum += static_cast<unsigned char>(ch);
+                    }
+                }
+            }
+            else
+            {
+                while (!quit)
+                {
+                    // read the payload in place, without copying it out of the queue
+                    consumer.pop_with([&](const JobMsgHeader& header, std::string_view payload) {
+                        quit = (JobMsgType::QUIT == header.type);
+                        for (const char ch : payload)
+                            sum += static_cast<unsigned char>(ch);
+                    });
+                    ++popped_batches;
+                }
+            }
+            msg_queue.notify();
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+            batches.fetch_add(popped_batches, std::memory_order_relaxed);
+        });
+    }
+
+    char payload[vtp::MAX_JOB_PAYLOAD_LENGTH];
+    for (std::size_t i = 0; i < sizeof(payload); ++i)
+        payload[i] = static_cast<char>('a' + i % 26);
+
+    const auto started = Clock::now();
+
+    // ready, set, go!
+    ready_flag.store(true);
+    ready_flag.notify_all();
+
+    JobMsgHeader header{JobMsgType::LIST_PUSH_BACK, 0};
+    for (int i = 0; i < messages; ++i)
+    {
+        header.payload_length = static_cast<std::uint8_t>(1 + i % 16);
+        while (vtp::PushStatus::OK != msg_queue.push_for(header, payload, PUSH_TIMEOUT))
+            ;
+    }
+
+    header = JobMsgHeader{JobMsgType::QUIT, 0};
+    for (int i = 0; i < workers; ++i)
+        while (vtp::PushStatus::OK != msg_queue.push_for(header, nullptr, PUSH_TIMEOUT))
+            ;
+
+    for (auto& t : threads)
+        t.join();
+
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+    return {elapsed.count(), checksum.load(), batches.load()};
+}
+
+struct PriorityResult
+{
+    double seconds;
+    vtp::HdrHistogram latency_wait; // `LIST_FIND`, push to pop
+    vtp::HdrHistogram bulk_wait;    // `LIST_PRINT`
+};
+
+/// One producer floods `LIST_PRINT` bulk jobs, with a `LIST_FIND` in between every `BULK_JOBS_PER_LATENCY_JOB`.
+/// Each job carries its push time, so the queue wait of each kind is measured the same way on any queue.
+template <typename JobQueue>
+void bench_priority(JobQueue& msg_queue, const int workers, const int messages, PriorityResult& result)
+{
+    std::atomic<bool> ready_flag = false;
+    std::vector<std::jthread> threads;
+    threads.reserve(workers);
+
+    for (int i = 0; i < workers; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            auto& consumer = vtp::job_consumer(msg_queue, i);
+            ready_flag.wait(false);
+
+            for (bool quit = false; !quit;)
+            {
+                JobMsgType type{};
+                Clock::time_point pushed{};
+                consumer.pop_with([&](const JobMsgHeader& header, std::string_view payload) {
+                    type = header.type;
+                    if (JobMsgType::QUIT != type)
+                        pushed = vtp::PodPayload<Clock::time_point>::read(payload);
+                });
+                const auto popped = Clock::now();
+
+                switch (type)
+                {
+                case JobMsgType::QUIT:
+                    quit = true;
+                    break;
+                case JobMsgType::LIST_FIND:
+                    result.latency_wait.record(popped - pushed);
+                    break;
+                default:
+                    result.bulk_wait.record(popped - pushed);
+                    while (Clock::now() - popped < BULK_SERVICE_TIME)
+                        ;
+                    break;
+                }
+            }
+            msg_queue.notify();
+        });
+    }
+
+    const auto started = Clock::now();
+
+    ready_flag.store(true);
+    ready_flag.notify_all();
+
+    for (int i = 0; i < messages; ++i)
+    {
+        const JobMsgType type =
+            (0 == i % (BULK_JOBS_PER_LATENCY_JOB + 1)) ? JobMsgType::LIST_FIND : JobMsgType::LIST_PRINT;
+        const JobMsgHeader header{type, sizeof(Clock::time_point)};
+        while (vtp::PushStatus::OK != msg_queue.push_with_for(
+                                          header,
+                                          [](char* dest) {
+                                              vtp::PodPayload<Clock::time_point>::write(dest, Clock::now());
+                                          },
+                                          PUSH_TIMEOUT))
+            ;
+    }
+
+    const JobMsgHeader quit{JobMsgType::QUIT, 0};
+    for (int i = 0; i < workers; ++i)
+        while (vtp::PushStatus::OK != msg_queue.push_for(quit, nullptr, PUSH_TIMEOUT))
+            ;
+
+    for (auto& t : threads)
+        t.join();
+
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+    result.seconds = elapsed.count();
+}
+
+/// State of the registry locks run, shared by every thread.
+/// Each handler checks who else is inside, so a handler run under the wrong lock (or none) is caught.
+struct LockedContext
+{
+    std::shared_mutex lock;
+    std::uint64_t total = 0; // written only under the exclusive lock
+
+    std::atomic<int> readers = 0;
+    std::atomic<int> writers = 0;
+    std::atomic<int> max_readers = 0;
+    std::atomic<bool> violated = false;
+};
+
+struct SharedRead
+{
+    static constexpr JobMsgType type = JobMsgType::LIST_FIND;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::SHARED;
+    static constexpr vtp::JobLane lane = vtp::JobLane::LATENCY;
+    using Payload = vtp::NoPayload;
+
+    static void handle(LockedContext& ctx)
+    {
+        const auto entered = Clock::now();
+        const int readers = ctx.readers.fetch_add(1) + 1;
+        for (int max = ctx.max_readers.load(); readers > max && !ctx.max_readers.compare_exchange_weak(max, readers);)
+            ;
+        if (0 != ctx.writers.load())
+            ctx.violated = true;
+        [[maybe_unused]] const std::uint64_t total = ctx.total;
+        while (Clock::now() - entered < SHARED_SERVICE_TIME)
+            ;
+        ctx.readers.fetch_sub(1);
+    }
+};
+
+struct ExclusiveAdd
+{
+    static constexpr JobMsgType type = JobMsgType::LIST_PUSH_BACK;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::EXCLUSIVE;
+    static constexpr vtp::JobLane lane = vtp::JobLane::BULK;
+    using Payload = vtp::PodPayload<std::uint64_t>;
+
+    static void handle(LockedContext& ctx, std::uint64_t value)
+    {
+        if (0 != ctx.writers.fetch_add(1) || 0 != ctx.readers.load())
+            ctx.violated = true;
+        ctx.total += value;
+        ctx.writers.fetch_sub(1);
+    }
+};
+
+using LockedRegistry = vtp::JobRegistry<SharedRead, ExclusiveAdd>;
+
+struct RegistryResult
+{
+    double seconds;
+    std::uint64_t total;
+    int max_readers;
+    bool violated;
+};
+
+/// `threads` threads encode and dispatch `messages` jobs in all through `LockedRegistry`, on one `LockedContext`,
+/// so that `SHARED` and `EXCLUSIVE` handlers run alongside each other.
+auto bench_registry(const int threads, const int messages) -> RegistryResult
+{
+    LockedContext ctx;
+    std::atomic<bool> ready_flag = false;
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            char payload[vtp::MAX_JOB_PAYLOAD_LENGTH];
+            ready_flag.wait(false);
+
+            for (int i = t; i < messages; i += threads)
+            {
+                if (0 == i % (SHARED_JOBS_PER_EXCLUSIVE_JOB + 1))
+                {
+                    auto job = LockedRegistry::encode<ExclusiveAdd>(static_cast<std::uint64_t>(i));
+                    job.write_payload(payload);
+                    LockedRegistry::dispatch(ctx, job.header, std::string_view(payload, job.header.payload_length));
+                }
+                else
+                {
+                    const auto job = LockedRegistry::encode<SharedRead>();
+                    LockedRegistry::dispatch(ctx, job.header, {});
+                }
+            }
+        });
+    }
+
+    const auto started = Clock::now();
+    ready_flag.store(true);
+    ready_flag.notify_all();
+    for (auto& t : workers)
+        t.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    return {elapsed.count(), ctx.total, ctx.max_readers.load(), ctx.violated.load()};
+}
+
+int main(int argc, char** argv)
+{
+    const int messages = (argc == 2) ? std::atoi(argv[1]) : DEFAULT_MESSAGES;
+    if (messages <= 0)
+    {
+        std::cout << "Usage: 06_job_queue_bench [messages]" << std::endl;
+        return 1;
+    }
+
+    // 1 + 2 + ... + 16 for every 16 messages
+    std::uint64_t expected_checksum = 0;
+    for (int i = 0; i < messages; ++i)
+        for (int j = 0; j < 1 + i % 16; ++j)
+            expected_checksum += 'a' + j % 26;
+
+    std::cout << std::format("{} messages, 1 producer\n", messages);
+    std::cout << std::format("{:>8} | {:>16} | {:>16} | {:>16} | {:>16} | {:>10} | {:>10} | {:>12}\n", "workers",
+                             "ring+mutex msg/s", "mirrored msg/s", "mpmc msg/s", "steal msg/s", "steals",
+                             "idle ms/w", "ring blk ms");
+
+    bool all_is_well = true;
+
+    for (const int workers : WORKER_COUNTS)
+    {
+        vtp::RingJobQueue ring_queue(RING_BUFFER_SIZE);
+        const auto ring = bench(ring_queue, workers, messages);
+
+        vtp::MirroredRingJobQueue mirrored_queue(RING_BUFFER_SIZE);
+        const auto mirrored = bench(mirrored_queue, workers, messages);
+
+        vtp::MpmcJobQueue mpmc_queue(MPMC_QUEUE_SLOTS);
+        const auto mpmc = bench(mpmc_queue, workers, messages);
+
+        vtp::WorkStealingJobQueue steal_queue(MPMC_QUEUE_SLOTS, workers);
+        const auto steal = bench(steal_queue, workers, messages);
+
+        std::uint64_t steals = 0;
+        std::chrono::duration<double, std::milli> idle_time{};
+        for (int i = 0; i < workers; ++i)
+        {
+            steals += steal_queue.worker(i).stats().steals;
+            idle_time += steal_queue.worker(i).stats().idle_time;
+        }
+
+        // time the producer spent blocked on a full ring
+        const std::chrono::duration<double, std::milli> ring_blocked = ring_queue.metrics().blocked_time;
+
+        std::cout << std::format(
+            "{:>8} | {:>16.0f} | {:>16.0f} | {:>16.0f} | {:>16.0f} | {:>10} | {:>10.1f} | {:>12.1f}\n", workers,
+            messages / ring.seconds, messages / mirrored.seconds, messages / mpmc.seconds, messages / steal.seconds,
+            steals, idle_time.count() / workers, ring_blocked.count());
+
+        if (ring.checksum != expected_checksum || mirrored.checksum != expected_checksum ||
+            mpmc.checksum != expected_checksum || steal.checksum != expected_checksum)
+        {
+            std::cout << std::format("checksum mismatch! expected={}, ring={}, mirrored={}, mpmc={}, steal={}\n",
+                                     expected_checksum, ring.checksum, mirrored.checksum, mpmc.checksum,
+                                     steal.checksum);
+            all_is_well = false;
+        }
+    }
+
+    std::cout << std::format("\nbatched dequeue, adaptive batch size up to {}\n", MAX_BATCH);
+    std::cout << std::format("{:>8} | {:>16} | {:>16} | {:>16} | {:>16} | {:>10}\n", "workers", "ring msg/s",
+                             "ring batched", "mpmc batched", "steal batched", "ring avg");
+
+    for (const int workers : WORKER_COUNTS)
+    {
+        vtp::RingJobQueue ring_queue(RING_BUFFER_SIZE);
+        const auto ring = bench(ring_queue, workers, messages);
+
+        vtp::RingJobQueue ring_batched_queue(RING_BUFFER_SIZE);
+        const auto ring_batched = bench(ring_batched_queue, workers, messages, MAX_BATCH);
+
+        vtp::MpmcJobQueue mpmc_queue(MPMC_QUEUE_SLOTS);
+        const auto mpmc_batched = bench(mpmc_queue, workers, messages, MAX_BATCH);
+
+        vtp::WorkStealingJobQueue steal_queue(MPMC_QUEUE_SLOTS, workers);
+        const auto steal_batched = bench(steal_queue, workers, messages, MAX_BATCH);
+
+        // messages + `QUIT`s per `pop_batch()`
+        const double ring_avg_batch = static_cast<double>(messages + workers) / ring_batched.batches;
+
+        std::cout << std::format("{:>8} | {:>16.0f} | {:>16.0f} | {:>16.0f} | {:>16.0f} | {:>10.1f}\n", workers,
+                                 messages / ring.seconds, messages / ring_batched.seconds,
+                                 messages / mpmc_batched.seconds, messages / steal_batched.seconds, ring_avg_batch);
+
+        if (ring_batched.checksum != expected_checksum || mpmc_batched.checksum != expected_checksum ||
+            steal_batched.checksum != expected_checksum)
+        {
+            std::cout << std::format("checksum mismatch! expected={}, ring={}, mpmc={}, steal={}\n",
+                                     expected_checksum, ring_batched.checksum, mpmc_batched.checksum,
+                                     steal_batched.checksum);
+            all_is_well = false;
+        }
+    }
+
+    // 벌크 일감이 워커를 다 잡아먹어도, 지연에 민감한 일감은 p99 가 묶여 있어야 함
+    std::cout << std::format("\npriority lanes, 1 LIST_FIND per {} LIST_PRINT busy for {}us, queue wait in us\n",
+                             BULK_JOBS_PER_LATENCY_JOB, BULK_SERVICE_TIME.count());
+    std::cout << std::format("{:>8} | {:>10} | {:>10} | {:>10} | {:>10} | {:>10} | {:>10}\n", "workers",
+                             "fifo find", "fifo p99", "lane find", "lane p99", "bulk p99", "lane msg/s");
+
+    static constexpr vtp::JobLaneMap LANE_MAP = [] {
+        vtp::JobLaneMap lanes;
+        lanes.fill(vtp::JobLane::BULK);
+        lanes[static_cast<std::size_t>(JobMsgType::LIST_FIND)] = vtp::JobLane::LATENCY;
+        lanes[static_cast<std::size_t>(JobMsgType::QUIT)] = vtp::JobLane::CONTROL;
+        return lanes;
+    }();
+
+    for (const int workers : PRIORITY_WORKER_COUNTS)
+    {
+        vtp::MpmcJobQueue fifo_queue(MPMC_QUEUE_SLOTS);
+        PriorityResult fifo;
+        bench_priority(fifo_queue, workers, messages, fifo);
+
+        vtp::LaneJobQueue lane_queue(MPMC_QUEUE_SLOTS, LANE_MAP);
+        PriorityResult lanes;
+        bench_priority(lane_queue, workers, messages, lanes);
+
+        std::cout << std::format("{:>8} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.0f}\n",
+                                 workers, fifo.latency_wait.percentile(50) / 1e3,
+                                 fifo.latency_wait.percentile(99) / 1e3, lanes.latency_wait.percentile(50) / 1e3,
+                                 lanes.latency_wait.percentile(99) / 1e3, lanes.bulk_wait.percentile(99) / 1e3,
+                                 messages / lanes.seconds);
+
+        const auto total = static_cast<std::uint64_t>(messages);
+        if (fifo.latency_wait.count() + fifo.bulk_wait.count() != total ||
+            lanes.latency_wait.count() + lanes.bulk_wait.count() != total)
+        {
+            std::cout << std::format("lost jobs! expected={}, fifo={}, lanes={}\n", total,
+                                     fifo.latency_wait.count() + fifo.bulk_wait.count(),
+                                     lanes.latency_wait.count() + lanes.bulk_wait.count());
+            all_is_well = false;
+        }
+    }
+
+    // 공유 락 일감끼리는 같이 돌고, 배타 락 일감은 혼자 돌아야 함
+    std::cout << std::format("\nregistry locks, 1 EXCLUSIVE per {} SHARED job on a std::shared_mutex, {} threads\n",
+                             SHARED_JOBS_PER_EXCLUSIVE_JOB, REGISTRY_THREADS);
+    {
+        const RegistryResult registry = bench_registry(REGISTRY_THREADS, messages);
+
+        std::uint64_t expected_total = 0;
+        for (int i = 0; i < messages; i += SHARED_JOBS_PER_EXCLUSIVE_JOB + 1)
+            expected_total += i;
+
+        std::cout << std::format("{:.0f} jobs/s, up to {} SHARED jobs at once\n", messages / registry.seconds,
+                                 registry.max_readers);
+
+        if (registry.violated || registry.total != expected_total)
+        {
+            std::cout << std::format("lock violated! expected total={}, total={}, violated={}\n", expected_total,
+                                     registry.total, registry.violated);
+            all_is_well = false;
+        }
+    }
+
+    return !all_is_well;
+}
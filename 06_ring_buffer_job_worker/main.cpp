@@ -1,187 +1,323 @@
-#include <NetBuff/RingByteBuffer.hpp>
-
+#include "ArenaResource.hpp"
+#include "ConcurrentSkipList.hpp"
+#include "JobMsg.hpp"
+#include "JobQueue.hpp"
+#include "JobRegistry.hpp"
+#include "JobTrace.hpp"
+#include "LaneJobQueue.hpp"
+#include "WorkStealingJobQueue.hpp"
+
+#include <vtp/AsyncOutputSink.hpp>
+
+#if defined(_WIN32)
 #define NOMINMAX
 #include <Windows.h>
-#include <process.h>
+#endif
 
-#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <format>
 #include <iostream>
-#include <limits>
-#include <list>
+#include <memory_resource>
+#include <optional>
 #include <random>
 #include <sstream>
-#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-void msg_queue_exception_exit()
-{
-    std::cout << "Something went wrong\n";
-    // TODO: 정상적인 종료 절차 밟기
-    throw std::logic_error("Something went wrong");
-}
-
 using Clock = std::chrono::steady_clock;
 using namespace std::chrono_literals;
 
+using vtp::JobMsg;
+using vtp::JobMsgHeader;
+using vtp::JobMsgType;
+
 static constexpr int WORKER_THREADS = 3;
 static constexpr Clock::duration MAIN_LOOP_WAIT_DURATION = 50ms;
 
+#if !defined(_WIN32)
+// 키 입력을 받을 수 없으니, `--duration` 없으면 이만큼만 돌고 종료
+static constexpr Clock::duration DEFAULT_RUN_DURATION = 5s;
+#endif
+
 static constexpr int RING_BUFFER_SIZE = 50'000;
+static constexpr int MPMC_QUEUE_SLOTS = 4096;
+
+// 큐가 꽉 차면 생산자는 이만큼 막혀 기다리고, 그래도 안 되면 일감을 버림
+static constexpr Clock::duration PUSH_TIMEOUT = MAIN_LOOP_WAIT_DURATION;
+
+// 큐에 쌓인 일감이 high 이상이면 생산 속도를 늦추고, low 이하로 내려오면 원래대로
+static constexpr std::size_t HIGH_WATERMARK = 1000;
+static constexpr std::size_t LOW_WATERMARK = 250;
+static constexpr int THROTTLED_WAIT_FACTOR = 4;
+
+#if defined(VTP_JOB_TRACING)
+// 일감 종류별 큐 대기 시간과 처리 시간을 이 주기로 출력
+static constexpr Clock::duration TRACE_DUMP_INTERVAL = 1s;
+#endif
 
-enum class JobMsgType : std::uint8_t
+// 리스트 노드는 삽입한 워커의 아레나에서 할당 (리스트보다 먼저 생성해서, 나중에 파괴되도록)
+std::array<vtp::ArenaResource, WORKER_THREADS> worker_arenas;
+
+// 항상 정렬된 상태로 유지되니, `LIST_SORT` 는 할 일이 없음
+vtp::ConcurrentSkipList<std::pmr::string> list;
+
+// 워커는 `std::cout` 에 직접 쓰지 않고, 자기 버퍼에 넣어두면 flusher 스레드가 대신 출력
+vtp::AsyncOutputSink output(std::cout);
+
+#if defined(VTP_JOB_TRACING)
+vtp::JobTracer job_tracer(WORKER_THREADS);
+#endif
+
+std::atomic<std::uint64_t> processed_jobs;
+std::atomic<bool> producer_throttled;
+
+static_assert(decltype(processed_jobs)::is_always_lock_free);
+
+/// What a job handler gets to work with, on its worker thread.
+struct WorkerContext
 {
-    LIST_PUSH_BACK,
-    LIST_POP_FRONT,
-    LIST_SORT,
-    LIST_FIND,
-    LIST_PRINT,
-    QUIT,
+    const int worker_id;
+    std::ostringstream& oss;
+    vtp::ArenaResource& arena;
 };
 
-struct JobMsgHeader
+// 리스트가 lock-free 이니, 모든 일감이 락 없이 돌아감
+
+struct ListPushBack
 {
-    JobMsgType type;
-    std::uint8_t payload_length;
+    static constexpr JobMsgType type = JobMsgType::LIST_PUSH_BACK;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::NONE;
+    static constexpr vtp::JobLane lane = vtp::JobLane::LATENCY;
+    using Payload = vtp::StringPayload;
+
+    static void handle(WorkerContext& ctx, std::string_view str)
+    {
+        list.insert(str, &ctx.arena);
+    }
+};
+
+struct ListPopFront
+{
+    static constexpr JobMsgType type = JobMsgType::LIST_POP_FRONT;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::NONE;
+    static constexpr vtp::JobLane lane = vtp::JobLane::LATENCY;
+    using Payload = vtp::NoPayload;
+
+    static void handle(WorkerContext&)
+    {
+        list.pop_front();
+    }
 };
 
-struct List
+struct ListSort
 {
-    std::list<std::string> list;
-    SRWLOCK lock;
-} list;
+    static constexpr JobMsgType type = JobMsgType::LIST_SORT;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::NONE;
+    static constexpr vtp::JobLane lane = vtp::JobLane::BULK;
+    using Payload = vtp::NoPayload;
 
-struct MsgQueue
+    static void handle(WorkerContext&)
+    {
+    }
+};
+
+struct ListFind
 {
-    nb::RingByteBuffer<> queue = nb::RingByteBuffer<>(RING_BUFFER_SIZE);
-    SRWLOCK lock;
-} msg_queue;
+    static constexpr JobMsgType type = JobMsgType::LIST_FIND;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::NONE;
+    static constexpr vtp::JobLane lane = vtp::JobLane::LATENCY;
+    using Payload = vtp::StringPayload;
 
-HANDLE event;
+    static void handle(WorkerContext& ctx, std::string_view str)
+    {
+        if (list.contains(str))
+            output.print("[Worker #{}] \"{}\" found in list\n", ctx.worker_id, str);
+        else
+            output.print("[Worker #{}] \"{}\" not found in list\n", ctx.worker_id, str);
+    }
+};
 
-unsigned __stdcall worker(void*)
+struct ListPrint
 {
-    const DWORD thread_id = GetCurrentThreadId();
+    static constexpr JobMsgType type = JobMsgType::LIST_PRINT;
+    static constexpr vtp::JobLockMode lock_mode = vtp::JobLockMode::NONE;
+    static constexpr vtp::JobLane lane = vtp::JobLane::BULK;
+    using Payload = vtp::NoPayload;
+
+    static void handle(WorkerContext& ctx)
+    {
+        std::ostringstream& oss = ctx.oss;
+        oss.str({});
+        oss << "[Worker #" << ctx.worker_id << "] list: [";
+        list.for_each([&oss](const std::pmr::string& str) { oss << str << ", "; });
+        oss << "]\n";
+        output.write(oss.view());
+    }
+};
 
+using ListJobs = vtp::JobRegistry<ListPushBack, ListPopFront, ListSort, ListFind, ListPrint>;
+
+template <typename JobQueue>
+void worker(JobQueue& msg_queue, const int worker_id, const vtp::BatchPolicy policy)
+{
     std::ostringstream oss;
+    WorkerContext ctx{worker_id, oss, worker_arenas[worker_id]};
 
-    for (;;)
+    std::uint64_t processed = 0;
+    std::uint64_t batches = 0;
+
+    auto& consumer = vtp::job_consumer(msg_queue, worker_id);
+    vtp::JobBatch batch(policy.max_batch);
+
+    for (bool quit = false; !quit;)
     {
-        JobMsgHeader header;
-        std::string payload_str;
+        // 한 번 깨어날 때 여러 일감을 한꺼번에 꺼내옴
+        consumer.pop_batch(batch, policy);
+        ++batches;
+
+#if defined(VTP_JOB_TRACING)
+        // 배치 안에서 기다린 시간도 큐 대기 시간으로 침
+        std::uint64_t started = vtp::JobClock::now();
+#endif
 
-        AcquireSRWLockExclusive(&msg_queue.lock);
+        for (const JobMsg& msg : batch.view())
         {
-            // 일감 없으면
-            while (msg_queue.queue.empty())
+            // 종료 메시지 처리 (`QUIT` 은 항상 배치의 마지막)
+            if (JobMsgType::QUIT == msg.header.type)
             {
-                // 메시지큐 락 해제 후 이벤트 대기
-                ReleaseSRWLockExclusive(&msg_queue.lock);
-                WaitForSingleObject(event, INFINITE);
-                // 다시 락 얻고 재시도
-                AcquireSRWLockExclusive(&msg_queue.lock);
+                msg_queue.notify();
+                quit = true;
+                break;
             }
 
-            // 일감이 있고, 내가 메시지큐 락을 소유하니, 내가 꺼내 처리할 준비
-            if (!msg_queue.queue.try_read(&header, sizeof(header)))
-                msg_queue_exception_exit();
-            if (JobMsgType::LIST_PUSH_BACK == header.type || JobMsgType::LIST_FIND == header.type)
-            {
-                payload_str.resize(header.payload_length);
-                if (!msg_queue.queue.try_read(payload_str.data(), header.payload_length))
-                    msg_queue_exception_exit();
-            }
-        }
-        ReleaseSRWLockExclusive(&msg_queue.lock);
+            ListJobs::dispatch(ctx, msg.header, msg.payload_view());
+            ++processed;
 
-        // 종료 메시지 처리
-        if (JobMsgType::QUIT == header.type)
-        {
-            SetEvent(event);
-            break;
+#if defined(VTP_JOB_TRACING)
+            const std::uint64_t finished = vtp::JobClock::now();
+            job_tracer.worker(worker_id).record(msg.header.type, msg.header.enqueued, started, finished);
+            started = finished;
+#endif
         }
+    }
 
-        // const bool is_shared_lock = (JobMsgType::LIST_FIND == header.type || JobMsgType::LIST_PRINT == header.type);
-        // auto lock_func = (is_shared_lock) ? AcquireSRWLockShared : AcquireSRWLockExclusive;
-        // auto unlock_func = (is_shared_lock) ? ReleaseSRWLockShared : ReleaseSRWLockExclusive;
+    processed_jobs.fetch_add(processed, std::memory_order_relaxed);
+    output.print("Worker #{} returns ({} jobs processed in {} batches)\n", worker_id, processed, batches);
+}
 
-        switch (header.type)
+enum class QueueKind
+{
+    RING,
+    MIRRORED,
+    MPMC,
+    STEAL,
+    LANES,
+};
+
+struct Options
+{
+    std::optional<Clock::duration> run_duration;
+    QueueKind queue_kind = QueueKind::RING;
+    std::size_t max_batch = 1;
+};
+
+/// Usage: 06_ring_buffer_job_worker [--duration <seconds>] [--queue ring|mirrored|mpmc|steal|lanes] [--batch <max>]
+///
+/// Without `--duration`, runs until 'Q' is pressed on Windows,
+/// or for `DEFAULT_RUN_DURATION` elsewhere (no keyboard polling there).
+///
+/// `--queue lanes` queues `LIST_PRINT`/`LIST_SORT` behind the other jobs, in weighted lanes (`vtp::LaneJobQueue`).
+///
+/// `--batch` lets a worker pop up to `<max>` jobs per wakeup, adapting to the queue depth (`vtp::BatchPolicy`).
+auto parse_options(int argc, char** argv) -> Options
+{
+    Options options;
+#if !defined(_WIN32)
+    options.run_duration = DEFAULT_RUN_DURATION;
+#endif
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const std::string_view value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--duration" && !value.empty())
         {
-        case JobMsgType::LIST_PUSH_BACK:
-            AcquireSRWLockExclusive(&list.lock);
-            {
-                list.list.push_back(std::move(payload_str));
-            }
-            ReleaseSRWLockExclusive(&list.lock);
-            payload_str.clear();
-            break;
-        case JobMsgType::LIST_POP_FRONT:
-            AcquireSRWLockExclusive(&list.lock);
-            {
-                if (!list.list.empty())
-                    list.list.pop_front();
-            }
-            ReleaseSRWLockExclusive(&list.lock);
-            break;
-        case JobMsgType::LIST_SORT:
-            AcquireSRWLockExclusive(&list.lock);
-            {
-                list.list.sort();
-            }
-            ReleaseSRWLockExclusive(&list.lock);
-            break;
-        case JobMsgType::LIST_FIND: {
-            bool found;
-            AcquireSRWLockShared(&list.lock);
-            {
-                auto it = std::find(list.list.cbegin(), list.list.cend(), payload_str);
-                found = (it != list.list.cend());
-            }
-            ReleaseSRWLockShared(&list.lock);
-            if (found)
-                std::cout << std::format("[TID #{}] \"{}\" found in list\n", thread_id, payload_str);
-            else
-                std::cout << std::format("[TID #{}] \"{}\" not found in list\n", thread_id, payload_str);
-            break;
+            options.run_duration =
+                std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::atof(argv[++i])));
         }
-        case JobMsgType::LIST_PRINT:
-            oss.clear();
-            oss << "[TID #" << thread_id << "] list: [";
-            AcquireSRWLockShared(&list.lock);
-            {
-                std::copy(list.list.cbegin(), list.list.cend(), std::ostream_iterator<std::string>(oss, ", "));
-            }
-            ReleaseSRWLockShared(&list.lock);
-            oss << "]\n";
-            std::cout << oss.str();
-            break;
-        default:
-            std::cout << "Should not reach here\n";
-            std::exit(-1); // TODO: `std::exit(-1)` 안 쓰고 종료 절차 밟기
+        else if (arg == "--queue" && value == "ring")
+        {
+            options.queue_kind = QueueKind::RING;
+            ++i;
+        }
+        else if (arg == "--queue" && value == "mirrored")
+        {
+            options.queue_kind = QueueKind::MIRRORED;
+            ++i;
+        }
+        else if (arg == "--queue" && value == "mpmc")
+        {
+            options.queue_kind = QueueKind::MPMC;
+            ++i;
+        }
+        else if (arg == "--queue" && value == "steal")
+        {
+            options.queue_kind = QueueKind::STEAL;
+            ++i;
+        }
+        else if (arg == "--queue" && value == "lanes")
+        {
+            options.queue_kind = QueueKind::LANES;
+            ++i;
+        }
+        else if (arg == "--batch" && std::atoi(value.data()) > 0)
+        {
+            options.max_batch = static_cast<std::size_t>(std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::cout << "Usage: 06_ring_buffer_job_worker [--duration <seconds>] "
+                         "[--queue ring|mirrored|mpmc|steal|lanes] [--batch <max>]"
+                      << std::endl;
+            std::exit(1);
         }
     }
 
-    std::cout << std::format("Worker #{} returns\n", thread_id);
-    return 0;
+    return options;
 }
 
-int main()
+template <typename JobQueue>
+void run(JobQueue& msg_queue, const Options& options)
 {
-    timeBeginPeriod(1);
-
-    event = CreateEvent(nullptr, false, false, nullptr);
-    InitializeSRWLock(&list.lock);
-    InitializeSRWLock(&msg_queue.lock);
-
-    std::vector<HANDLE> threads;
+    msg_queue.set_watermarks(vtp::QueueWatermarks{
+        .high = HIGH_WATERMARK,
+        .low = LOW_WATERMARK,
+        .on_high =
+            [](std::size_t depth) {
+                producer_throttled.store(true, std::memory_order_relaxed);
+                output.print("[Producer] {} jobs queued, slowing down\n", depth);
+            },
+        .on_low =
+            [](std::size_t depth) {
+                producer_throttled.store(false, std::memory_order_relaxed);
+                output.print("[Producer] {} jobs queued, back to normal\n", depth);
+            },
+    });
+
+    const vtp::BatchPolicy batch_policy{.max_batch = options.max_batch, .workers = WORKER_THREADS};
+
+    std::vector<std::jthread> threads;
     threads.reserve(WORKER_THREADS);
     for (int i = 0; i < WORKER_THREADS; ++i)
-        threads.push_back((HANDLE)_beginthreadex(nullptr, 0, worker, nullptr, 0, nullptr));
+        threads.emplace_back(worker<JobQueue>, std::ref(msg_queue), i, batch_policy);
 
     std::mt19937 rng(std::random_device{}());
 
@@ -189,83 +325,175 @@ int main()
     std::uniform_int_distribution<int> random_length(1, 7);
     std::uniform_int_distribution<int> random_char('a', 'z');
 
-    std::string str;
-    str.reserve(std::numeric_limits<decltype(JobMsgHeader::payload_length)>::max());
-
-    auto update_random_str = [&str, &rng, &random_char](int length) {
-        str.clear();
-        for (int i = 0; i < length; ++i)
-            str.push_back(static_cast<char>(random_char(rng)));
+    // 무작위 문자열은 메시지큐 안에 바로 씀
+    auto make_random_job = [&]<typename Job>() {
+        if constexpr (ListJobs::has_payload_v<Job>)
+        {
+            const auto length = static_cast<std::size_t>(random_length(rng));
+            return ListJobs::encode<Job>(length, [&rng, &random_char, length](char* dest) {
+                for (std::size_t i = 0; i < length; ++i)
+                    dest[i] = static_cast<char>(random_char(rng));
+            });
+        }
+        else
+            return ListJobs::encode<Job>();
     };
 
-    auto now = Clock::now();
-    auto next_sleep = now + MAIN_LOOP_WAIT_DURATION;
+    std::uint64_t shed_jobs = 0;
 
-    JobMsgHeader header;
+    const auto started = Clock::now();
+    auto now = started;
+    auto next_sleep = now + MAIN_LOOP_WAIT_DURATION;
+#if defined(VTP_JOB_TRACING)
+    auto next_trace_dump = now + TRACE_DUMP_INTERVAL;
+#endif
 
     for (;;)
     {
-        // 'Q' 눌리면, 종료 절차 시작
-        if (1 & GetAsyncKeyState('Q'))
+        // 지정된 시간이 지났거나, 'Q' 눌리면, 종료 절차 시작
+        if (options.run_duration)
+        {
+            if (now - started >= *options.run_duration)
+                break;
+        }
+#if defined(_WIN32)
+        else if (1 & GetAsyncKeyState('Q'))
             break;
+#endif
 
         // 일감 생성
-        header.type = static_cast<JobMsgType>(random_job(rng));
-        header.payload_length = 0;
+        ListJobs::visit(static_cast<JobMsgType>(random_job(rng)), [&]<typename Job>() {
+            auto job = make_random_job.template operator()<Job>();
 
-        if (JobMsgType::LIST_PUSH_BACK == header.type || JobMsgType::LIST_FIND == header.type)
-        {
-            header.payload_length = static_cast<decltype(JobMsgHeader::payload_length)>(random_length(rng));
-            update_random_str(header.payload_length);
-        }
+            // 꽉 찼으면 잠시 막혀 기다리고, 그래도 자리가 안 나면 이번 일감은 버림
+            if (vtp::PushStatus::OK != msg_queue.push_with_for(job.header, job.write_payload, PUSH_TIMEOUT))
+                ++shed_jobs;
+        });
 
-        AcquireSRWLockExclusive(&msg_queue.lock);
+#if defined(VTP_JOB_TRACING)
+        if (now >= next_trace_dump)
         {
-            if (!msg_queue.queue.try_write(&header, sizeof(header)))
-                msg_queue_exception_exit();
-
-            if (header.payload_length)
-                if (!msg_queue.queue.try_write(str.data(), header.payload_length))
-                    msg_queue_exception_exit();
+            output.write(job_tracer.dump());
+            next_trace_dump += TRACE_DUMP_INTERVAL;
         }
-        ReleaseSRWLockExclusive(&msg_queue.lock);
-
-        std::atomic_thread_fence(std::memory_order_seq_cst);
-
-        SetEvent(event);
+#endif
 
         // sleep
         now = Clock::now();
         if (next_sleep > now)
             std::this_thread::sleep_for(next_sleep - now);
-        next_sleep += MAIN_LOOP_WAIT_DURATION;
+        next_sleep += producer_throttled.load(std::memory_order_relaxed)
+                          ? MAIN_LOOP_WAIT_DURATION * THROTTLED_WAIT_FACTOR
+                          : MAIN_LOOP_WAIT_DURATION;
+        now = Clock::now();
     }
 
-    // 종료 메시지 enqueue
-    header.type = JobMsgType::QUIT;
-    header.payload_length = 0;
+    // 종료 메시지 enqueue (QUIT 받은 워커가 다음 워커를 연쇄적으로 깨움)
+    const JobMsgHeader header{JobMsgType::QUIT, 0};
+
+    // 종료 메시지는 버릴 수 없으니, 자리 날 때까지 기다림
+    for (int i = 0; i < WORKER_THREADS; ++i)
+        while (vtp::PushStatus::OK != msg_queue.push_for(header, nullptr, PUSH_TIMEOUT))
+            ;
+
+    for (auto& t : threads)
+        t.join();
+
+    // 워커들이 남긴 출력을 먼저 내보낸 뒤 요약 출력
+    output.flush();
+
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+    const auto total = processed_jobs.load(std::memory_order_relaxed);
+    std::cout << std::format("{} jobs processed in {:.2f}s ({:.1f} jobs/s)\n", total, elapsed.count(),
+                             total / elapsed.count());
 
-    AcquireSRWLockExclusive(&msg_queue.lock);
+    const vtp::QueueMetrics metrics = msg_queue.metrics();
+    std::cout << std::format("Queue: max depth {}, {} pushes blocked for {}ms total ({} timed out), {} jobs shed\n",
+                             metrics.max_depth, metrics.blocked,
+                             std::chrono::duration_cast<std::chrono::milliseconds>(metrics.blocked_time).count(),
+                             metrics.timed_out, shed_jobs);
+
+    const vtp::AsyncOutputSink::Stats output_stats = output.stats();
+    std::cout << std::format("Output: {} lines ({} bytes) from {} threads, {} dropped\n",
+                             output_stats.written_messages, output_stats.written_bytes, output_stats.producer_buffers,
+                             output_stats.dropped_messages);
+
+#if defined(VTP_JOB_TRACING)
+    std::cout << job_tracer.dump();
+#endif
+
+    for (int i = 0; i < WORKER_THREADS; ++i)
+    {
+        const auto stats = worker_arenas[i].stats();
+        std::cout << std::format("Arena #{}: {} chunks allocated, {} reused, {} large blocks\n", i,
+                                 stats.chunks_allocated, stats.chunks_reused, stats.large_blocks);
+    }
+
+    if constexpr (std::is_same_v<JobQueue, vtp::WorkStealingJobQueue>)
     {
         for (int i = 0; i < WORKER_THREADS; ++i)
-            if (!msg_queue.queue.try_write(&header, sizeof(header)))
-                msg_queue_exception_exit();
+        {
+            const auto& stats = msg_queue.worker(i).stats();
+            std::cout << std::format("Worker #{}: {} local, {} injected, {} stolen ({} failed), idle {}ms\n", i,
+                                     stats.popped_local, stats.popped_injected, stats.steals, stats.failed_steals,
+                                     std::chrono::duration_cast<std::chrono::milliseconds>(stats.idle_time).count());
+        }
     }
-    ReleaseSRWLockExclusive(&msg_queue.lock);
 
-    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if constexpr (std::is_same_v<JobQueue, vtp::LaneJobQueue>)
+    {
+        for (const auto& [lane, name] : {std::pair{vtp::JobLane::CONTROL, "control"},
+                                        std::pair{vtp::JobLane::LATENCY, "latency"},
+                                        std::pair{vtp::JobLane::BULK, "bulk"}})
+        {
+            const vtp::HdrHistogram& wait = msg_queue.lane_wait(lane);
+            std::cout << std::format("Lane {}: {} jobs, queue wait p50 {}us, p99 {}us, max {}us\n", name,
+                                     wait.count(), wait.percentile(50) / 1000, wait.percentile(99) / 1000,
+                                     wait.max() / 1000);
+        }
+    }
+}
 
-    // 워커 스레드 깨우기
-    for (int i = 0; i < WORKER_THREADS; ++i)
-        SetEvent(event);
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
 
-    WaitForMultipleObjects(WORKER_THREADS, threads.data(), true, INFINITE);
+#if defined(_WIN32)
+    timeBeginPeriod(1);
+#endif
 
-    for (HANDLE h : threads)
-        CloseHandle(h);
-    CloseHandle(event);
+    switch (options.queue_kind)
+    {
+    case QueueKind::RING: {
+        vtp::RingJobQueue msg_queue(RING_BUFFER_SIZE);
+        run(msg_queue, options);
+        break;
+    }
+    case QueueKind::MIRRORED: {
+        vtp::MirroredRingJobQueue msg_queue(RING_BUFFER_SIZE);
+        run(msg_queue, options);
+        break;
+    }
+    case QueueKind::MPMC: {
+        vtp::MpmcJobQueue msg_queue(MPMC_QUEUE_SLOTS);
+        run(msg_queue, options);
+        break;
+    }
+    case QueueKind::STEAL: {
+        vtp::WorkStealingJobQueue msg_queue(MPMC_QUEUE_SLOTS, WORKER_THREADS);
+        run(msg_queue, options);
+        break;
+    }
+    case QueueKind::LANES: {
+        vtp::LaneJobQueue msg_queue(MPMC_QUEUE_SLOTS, ListJobs::lane_map());
+        run(msg_queue, options);
+        break;
+    }
+    }
 
     std::cout << "Goodbye!" << std::endl;
 
+#if defined(_WIN32)
     timeEndPeriod(1);
+#endif
 }
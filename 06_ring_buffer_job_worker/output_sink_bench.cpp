@@ -0,0 +1,135 @@
+#include "ConcurrentSkipList.hpp"
+
+#include <vtp/AsyncOutputSink.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int DEFAULT_JOBS = 200'000;
+static constexpr int THREAD_COUNTS[] = {1, 3, 16};
+static constexpr int LIST_SIZE = 1000;
+
+enum class OutputMode
+{
+    NONE,
+    COUT,
+    SINK_DROP,
+    SINK_BLOCK,
+};
+
+auto random_string(std::mt19937& rng) -> std::string
+{
+    std::uniform_int_distribution<int> random_length(1, 7);
+    std::uniform_int_distribution<int> random_char('a', 'z');
+
+    std::string str(random_length(rng), ' ');
+    for (char& ch : str)
+        ch = static_cast<char>(random_char(rng));
+    return str;
+}
+
+struct BenchResult
+{
+    double seconds;
+    std::uint64_t dropped = 0;
+};
+
+/// `threads` workers run `jobs` `LIST_FIND`-like jobs in total, each printing a line the way `mode` says.
+auto bench(vtp::ConcurrentSkipList<std::pmr::string>& list, const std::vector<std::string>& lookups,
+           const int threads, const int jobs, const OutputMode mode) -> BenchResult
+{
+    vtp::AsyncOutputSink sink(std::cout, {.full_policy = OutputMode::SINK_BLOCK == mode
+                                                             ? vtp::SinkFullPolicy::BLOCK
+                                                             : vtp::SinkFullPolicy::DROP});
+
+    std::atomic<std::uint64_t> found_total = 0;
+    const auto started = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                std::uint64_t found_count = 0;
+                for (int i = jobs * t / threads; i < jobs * (t + 1) / threads; ++i)
+                {
+                    const std::string_view str = lookups[i % lookups.size()];
+                    const bool found = list.contains(str);
+                    found_count += found;
+
+                    switch (mode)
+                    {
+                    case OutputMode::NONE:
+                        break;
+                    case OutputMode::COUT:
+                        std::cout << std::format("[Worker #{}] \"{}\" {}found in list\n", t, str, found ? "" : "not ");
+                        break;
+                    case OutputMode::SINK_DROP:
+                    case OutputMode::SINK_BLOCK:
+                        sink.print("[Worker #{}] \"{}\" {}found in list\n", t, str, found ? "" : "not ");
+                        break;
+                    }
+                }
+                found_total += found_count;
+            });
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    // 워커 처리량만 재고, 남은 출력은 그 뒤에 내보냄
+    sink.flush();
+    return {elapsed.count(), sink.stats().dropped_messages};
+}
+
+/// Redirect the stdout to a file or `/dev/null` (or a terminal, to see how slow it is); the table goes to stderr.
+int main(int argc, char** argv)
+{
+    const int jobs = (argc == 2) ? std::atoi(argv[1]) : DEFAULT_JOBS;
+    if (jobs <= 0)
+    {
+        std::clog << "Usage: 06_output_sink_bench [jobs] > /dev/null" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(42);
+    vtp::ConcurrentSkipList<std::pmr::string> list;
+    for (int i = 0; i < LIST_SIZE; ++i)
+        list.insert(random_string(rng));
+
+    std::vector<std::string> lookups(LIST_SIZE);
+    for (auto& str : lookups)
+        str = random_string(rng);
+
+    std::clog << std::format("{} jobs printing a line each, worker throughput in jobs/s\n", jobs);
+    std::clog << std::format("{:>8} | {:>12} | {:>12} | {:>12} | {:>12} | {:>10}\n", "threads", "no output",
+                             "std::cout", "sink block", "sink drop", "dropped");
+
+    for (const int threads : THREAD_COUNTS)
+    {
+        const auto none = bench(list, lookups, threads, jobs, OutputMode::NONE);
+        const auto cout = bench(list, lookups, threads, jobs, OutputMode::COUT);
+        const auto sink_block = bench(list, lookups, threads, jobs, OutputMode::SINK_BLOCK);
+        const auto sink_drop = bench(list, lookups, threads, jobs, OutputMode::SINK_DROP);
+
+        std::clog << std::format("{:>8} | {:>12.0f} | {:>12.0f} | {:>12.0f} | {:>12.0f} | {:>10}\n", threads,
+                                 jobs / none.seconds, jobs / cout.seconds, jobs / sink_block.seconds,
+                                 jobs / sink_drop.seconds, sink_drop.dropped);
+
+        if (sink_block.dropped)
+        {
+            std::clog << std::format("`BLOCK` sink dropped {} lines!\n", sink_block.dropped);
+            return 1;
+        }
+    }
+}
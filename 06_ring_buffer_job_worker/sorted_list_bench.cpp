@@ -0,0 +1,287 @@
+#include "ArenaResource.hpp"
+#include "ConcurrentSkipList.hpp"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int DEFAULT_STRINGS = 1'000'000;
+static constexpr int THREAD_COUNTS[] = {1, 3, 16};
+
+// `std::list` 선형 탐색은 너무 느리니, 이만큼만 찾아봄
+static constexpr int LIST_FINDS = 100;
+
+// 힙 할당 횟수를 세기 위해 전역 `operator new` 교체
+static std::atomic<std::uint64_t> heap_allocs;
+
+void* operator new(std::size_t size)
+{
+    heap_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    heap_allocs.fetch_add(1, std::memory_order_relaxed);
+#if defined(_WIN32)
+    if (void* ptr = _aligned_malloc(size ? size : 1, static_cast<std::size_t>(alignment)))
+#else
+    if (void* ptr = std::aligned_alloc(static_cast<std::size_t>(alignment),
+                                       (size + static_cast<std::size_t>(alignment) - 1) &
+                                           ~(static_cast<std::size_t>(alignment) - 1)))
+#endif
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(ptr, alignment);
+}
+
+auto current_rss() -> std::size_t
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.WorkingSetSize;
+#else
+    long pages = 0, resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r"))
+    {
+        if (2 != std::fscanf(statm, "%ld %ld", &pages, &resident))
+            resident = 0;
+        std::fclose(statm);
+    }
+    return static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+auto to_mib(std::size_t bytes) -> double
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+auto random_strings(int count, unsigned seed) -> std::vector<std::string>
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> random_length(4, 16);
+    std::uniform_int_distribution<int> random_char('a', 'z');
+
+    std::vector<std::string> strings(count);
+    for (auto& str : strings)
+    {
+        str.resize(random_length(rng));
+        for (char& ch : str)
+            ch = static_cast<char>(random_char(rng));
+    }
+    return strings;
+}
+
+/// Runs `func(thread_index, begin, end)` over `[0, count)` split into `threads` chunks, and returns the seconds taken.
+template <typename Func>
+auto run_parallel(int threads, int count, Func&& func) -> double
+{
+    const auto started = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&, t]() { func(t, count * t / threads, count * (t + 1) / threads); });
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+    return elapsed.count();
+}
+
+auto ns_per_op(double seconds, int ops) -> double
+{
+    return seconds * 1e9 / ops;
+}
+
+int main(int argc, char** argv)
+{
+    const int count = (argc == 2) ? std::atoi(argv[1]) : DEFAULT_STRINGS;
+    if (count <= 0)
+    {
+        std::cout << "Usage: 06_sorted_list_bench [strings]" << std::endl;
+        return 1;
+    }
+
+    const auto strings = random_strings(count, 42);
+    // half of them present, half (most likely) not
+    auto lookups = random_strings(count / 2, 43);
+    lookups.insert(lookups.end(), strings.begin(), strings.begin() + (count - count / 2));
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(44));
+
+    bool all_is_well = true;
+
+    std::cout << std::format("{} strings, ns/op, heap allocations per insert, and RSS growth after inserting\n",
+                             count);
+    std::cout << std::format("{:>28} | {:>8} | {:>10} | {:>10} | {:>10} | {:>10} | {:>10} | {:>8}\n", "container",
+                             "threads", "insert", "sort", "find", "pop_front", "allocs/op", "RSS MiB");
+
+    // 기존 방식: `std::list` + `std::shared_mutex`, 단일 스레드
+    {
+        std::list<std::string> list;
+        std::shared_mutex lock;
+
+        const std::size_t rss_before = current_rss();
+        const std::uint64_t allocs_before = heap_allocs.load();
+
+        auto started = Clock::now();
+        for (const auto& str : strings)
+        {
+            std::unique_lock guard(lock);
+            list.emplace_back(str);
+        }
+        const std::chrono::duration<double> insert_time = Clock::now() - started;
+
+        const double allocs_per_op = static_cast<double>(heap_allocs.load() - allocs_before) / count;
+        const double rss_growth = to_mib(current_rss() - std::min(current_rss(), rss_before));
+
+        started = Clock::now();
+        {
+            std::unique_lock guard(lock);
+            list.sort();
+        }
+        const std::chrono::duration<double> sort_time = Clock::now() - started;
+
+        const int finds = std::min(LIST_FINDS, static_cast<int>(lookups.size()));
+        int found = 0;
+        started = Clock::now();
+        for (int i = 0; i < finds; ++i)
+        {
+            std::shared_lock guard(lock);
+            found += (std::find(list.cbegin(), list.cend(), lookups[i]) != list.cend());
+        }
+        const std::chrono::duration<double> find_time = Clock::now() - started;
+
+        started = Clock::now();
+        while (!list.empty())
+        {
+            std::unique_lock guard(lock);
+            list.pop_front();
+        }
+        const std::chrono::duration<double> pop_time = Clock::now() - started;
+
+        std::cout << std::format(
+            "{:>28} | {:>8} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.2f} | {:>8.1f}\n",
+            "std::list + shared_mutex", 1, ns_per_op(insert_time.count(), count), ns_per_op(sort_time.count(), count),
+            ns_per_op(find_time.count(), finds), ns_per_op(pop_time.count(), count), allocs_per_op, rss_growth);
+        if (found < finds / 4)
+            all_is_well = false;
+    }
+
+    for (const bool use_arenas : {false, true})
+    {
+        for (const int threads : THREAD_COUNTS)
+        {
+            // 스레드마다 아레나 하나씩 (리스트보다 오래 살아야 함)
+            std::deque<vtp::ArenaResource> arenas(use_arenas ? threads : 0);
+            vtp::ConcurrentSkipList<std::pmr::string> list;
+
+            const std::size_t rss_before = current_rss();
+            const std::uint64_t allocs_before = heap_allocs.load();
+
+            const double insert_time = run_parallel(threads, count, [&](int t, int begin, int end) {
+                std::pmr::memory_resource* resource = use_arenas ? &arenas[t] : std::pmr::get_default_resource();
+                for (int i = begin; i < end; ++i)
+                    list.insert(std::string_view(strings[i]), resource);
+            });
+
+            const double allocs_per_op = static_cast<double>(heap_allocs.load() - allocs_before) / count;
+            const double rss_growth = to_mib(current_rss() - std::min(current_rss(), rss_before));
+
+            // 따로 정렬할 필요 없이 이미 정렬되어 있어야 함
+            std::size_t visited = 0;
+            bool sorted = true;
+            const std::pmr::string* prev = nullptr;
+            list.for_each([&](const std::pmr::string& str) {
+                sorted = sorted && (!prev || *prev <= str);
+                prev = &str;
+                ++visited;
+            });
+
+            std::atomic<int> found = 0;
+            const double find_time =
+                run_parallel(threads, static_cast<int>(lookups.size()), [&](int, int begin, int end) {
+                    int my_found = 0;
+                    for (int i = begin; i < end; ++i)
+                        my_found += list.contains(std::string_view(lookups[i]));
+                    found += my_found;
+                });
+
+            std::atomic<int> popped = 0;
+            const double pop_time = run_parallel(threads, count, [&](int, int begin, int end) {
+                int my_popped = 0;
+                for (int i = begin; i < end; ++i)
+                    my_popped += list.pop_front().has_value();
+                popped += my_popped;
+            });
+
+            std::cout << std::format(
+                "{:>28} | {:>8} | {:>10.1f} | {:>10} | {:>10.1f} | {:>10.1f} | {:>10.2f} | {:>8.1f}\n",
+                use_arenas ? "ConcurrentSkipList + arena" : "ConcurrentSkipList", threads,
+                ns_per_op(insert_time, count), "-", ns_per_op(find_time, static_cast<int>(lookups.size())),
+                ns_per_op(pop_time, count), allocs_per_op, rss_growth);
+
+            if (!sorted || visited != static_cast<std::size_t>(count) || popped != count ||
+                found < count - count / 2 || list.size_approx() != 0)
+            {
+                std::cout << std::format("verification failed! sorted={}, visited={}, found={}, popped={}\n",
+                                         sorted, visited, found.load(), popped.load());
+                all_is_well = false;
+            }
+        }
+    }
+
+    return !all_is_well;
+}
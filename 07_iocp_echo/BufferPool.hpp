@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+class PooledBuffer;
+
+/// Process-wide pool of I/O buffers in power-of-2 size classes, from `MIN_SIZE` up to `MAX_SIZE`.
+///
+/// Every thread caches up to `THREAD_CACHE_LIMIT` buffers of each class, so acquiring and releasing takes no lock
+/// until its cache runs dry or overflows; then a batch moves from/to the shared free list of that class at once.
+/// Buffers never go back to the OS, so the pool's footprint is its high-water mark.
+class BufferPool
+{
+public:
+    static constexpr std::size_t MIN_SIZE = 2 * 1024;
+    static constexpr std::size_t SIZE_CLASSES = 6; // 2 KiB ~ 64 KiB
+    static constexpr std::size_t MAX_SIZE = MIN_SIZE << (SIZE_CLASSES - 1);
+
+    // 넘치면 절반만 공유 목록으로 돌려서, 경계에서 락을 반복해 잡지 않게 함
+    static constexpr std::size_t THREAD_CACHE_LIMIT = 64;
+
+private:
+    static constexpr std::align_val_t ALIGNMENT{64};
+
+public:
+    static auto instance() -> BufferPool&
+    {
+        static BufferPool pool;
+        return pool;
+    }
+
+    static constexpr auto size_of(std::size_t size_class) -> std::size_t
+    {
+        return MIN_SIZE << size_class;
+    }
+
+    /// Smallest class of at least `min_size` bytes, or the largest one.
+    static constexpr auto size_class_of(std::size_t min_size) -> std::size_t
+    {
+        std::size_t size_class = 0;
+        while (size_class + 1 < SIZE_CLASSES && size_of(size_class) < min_size)
+            ++size_class;
+        return size_class;
+    }
+
+public:
+    auto acquire(std::size_t size_class) -> PooledBuffer;
+
+    /// Bytes allocated from the OS so far.
+    auto reserved_bytes() const -> std::size_t
+    {
+        return _reserved_bytes.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class PooledBuffer;
+
+    struct FreeList
+    {
+        std::mutex lock;
+        std::vector<std::byte*> buffers;
+    };
+
+    struct ThreadCache
+    {
+        std::array<std::vector<std::byte*>, SIZE_CLASSES> buffers;
+
+        ~ThreadCache()
+        {
+            for (std::size_t size_class = 0; size_class < SIZE_CLASSES; ++size_class)
+                BufferPool::instance().drain(size_class, buffers[size_class], 0);
+        }
+    };
+
+    static auto thread_cache() -> ThreadCache&
+    {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    BufferPool() = default;
+
+    ~BufferPool()
+    {
+        for (FreeList& list : _free)
+        {
+            for (std::byte* const buffer : list.buffers)
+                ::operator delete(buffer, ALIGNMENT);
+        }
+    }
+
+    void release(std::byte* buffer, std::size_t size_class)
+    {
+        std::vector<std::byte*>& cache = thread_cache().buffers[size_class];
+        cache.push_back(buffer);
+        if (cache.size() > THREAD_CACHE_LIMIT)
+            drain(size_class, cache, THREAD_CACHE_LIMIT / 2);
+    }
+
+    /// Takes half a cache from the shared free list, or allocates one buffer if it's empty.
+    void refill(std::size_t size_class, std::vector<std::byte*>& cache)
+    {
+        {
+            FreeList& list = _free[size_class];
+            std::lock_guard guard(list.lock);
+            const std::size_t count = std::min(list.buffers.size(), THREAD_CACHE_LIMIT / 2);
+            cache.insert(cache.end(), list.buffers.end() - count, list.buffers.end());
+            list.buffers.resize(list.buffers.size() - count);
+        }
+
+        if (cache.empty())
+        {
+            cache.push_back(static_cast<std::byte*>(::operator new(size_of(size_class), ALIGNMENT)));
+            _reserved_bytes.fetch_add(size_of(size_class), std::memory_order_relaxed);
+        }
+    }
+
+    /// Moves all but `keep` buffers of `cache` to the shared free list.
+    void drain(std::size_t size_class, std::vector<std::byte*>& cache, std::size_t keep)
+    {
+        if (cache.size() <= keep)
+            return;
+
+        FreeList& list = _free[size_class];
+        std::lock_guard guard(list.lock);
+        list.buffers.insert(list.buffers.end(), cache.begin() + keep, cache.end());
+        cache.resize(keep);
+    }
+
+private:
+    std::array<FreeList, SIZE_CLASSES> _free;
+    std::atomic<std::size_t> _reserved_bytes = 0;
+};
+
+/// Buffer lent by `BufferPool`; goes back to the cache of the thread that destroys (or resets) it.
+class PooledBuffer
+{
+public:
+    PooledBuffer() = default;
+
+    ~PooledBuffer()
+    {
+        reset();
+    }
+
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)), _size_class(other._size_class)
+    {
+    }
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            _data = std::exchange(other._data, nullptr);
+            _size_class = other._size_class;
+        }
+        return *this;
+    }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+public:
+    auto data() const -> std::byte*
+    {
+        return _data;
+    }
+
+    /// `0` if nothing is lent.
+    auto size() const -> std::size_t
+    {
+        return _data ? BufferPool::size_of(_size_class) : 0;
+    }
+
+    auto size_class() const -> std::size_t
+    {
+        return _size_class;
+    }
+
+    explicit operator bool() const
+    {
+        return _data;
+    }
+
+    /// Gives the buffer back to the pool.
+    void reset()
+    {
+        if (_data)
+            BufferPool::instance().release(std::exchange(_data, nullptr), _size_class);
+    }
+
+private:
+    friend class BufferPool;
+
+    PooledBuffer(std::byte* data, std::size_t size_class) : _data(data), _size_class(size_class)
+    {
+    }
+
+private:
+    std::byte* _data = nullptr;
+    std::size_t _size_class = 0;
+};
+
+inline auto BufferPool::acquire(std::size_t size_class) -> PooledBuffer
+{
+    std::vector<std::byte*>& cache = thread_cache().buffers[size_class];
+    if (cache.empty())
+        refill(size_class, cache);
+
+    std::byte* const buffer = cache.back();
+    cache.pop_back();
+    return PooledBuffer(buffer, size_class);
+}
@@ -0,0 +1,604 @@
+#pragma once
+
+#include "Framing.hpp"
+#include "SessionBuffer.hpp"
+#include "TimerWheel.hpp"
+#include "ZeroCopy.hpp"
+#include "linux_common.hpp"
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Edge-triggered epoll event loop of one worker thread, owning the sessions handed to it,
+/// or accepted on its own listener.
+///
+/// Each socket is registered once for both directions; on an edge, the session echoes until
+/// the socket would block both ways, remembering which direction is blocked so that it doesn't retry it.
+///
+/// A session silent for too long, or one whose peer stopped taking its echoes, is closed by the worker's timer wheel.
+///
+/// With `use_framing()`, the stream is length-prefixed messages instead of raw bytes: each one is parsed in place
+/// on the ring buffer and handled by `on_message()`, and the replies go out together in one `writev()`.
+///
+/// With `use_zerocopy()`, large echoes are sent with `MSG_ZEROCOPY`: their ring buffer space is released only when
+/// the kernel's completion arrives on the error queue, and the next send starts after them meanwhile.
+class EpollWorker
+{
+private:
+    using Clock = TimerWheel::Clock;
+
+    // 가장 큰 메시지 둘: 하나를 돌려보내는 동안 다음 것을 받음
+    static constexpr std::size_t FRAMED_RING_BUF_SIZE = 2 * (MAX_FRAME_HEADER_SIZE + MAX_MESSAGE_SIZE);
+
+    // zero-copy 가 이득인 크기로 보내려면, 완료를 기다리는 동안에도 받을 자리가 남아야 함
+    static constexpr std::size_t ZEROCOPY_RING_BUF_SIZE = 256 * 1024;
+
+    struct Session
+    {
+        UniqueFd sock;
+        SessionBuffer buf;
+        std::uint32_t serial; // tells this session from a later one on the same fd, in its timer key
+
+        // framed only: replies to the messages on the front of `buf`, which is released once they're all sent
+        std::unique_ptr<ReplyBatch> replies;
+        std::size_t replied = 0; // bytes of those messages
+
+        // zero-copy only, and only if the socket took `SO_ZEROCOPY`
+        std::unique_ptr<ZeroCopySends> zerocopy;
+
+        // cleared on a short read/write, set again on the next edge
+        bool can_read = true;
+        bool can_write = true;
+
+        Clock::time_point last_received;
+        Clock::time_point last_sent; // or when the bytes waiting to be echoed started to wait
+
+        Session(int fd, std::uint32_t serial_, std::size_t buf_size, bool framed, bool zerocopy,
+                Clock::time_point now)
+            : sock(fd), buf(buf_size), serial(serial_), replies(framed ? std::make_unique<ReplyBatch>() : nullptr),
+              zerocopy(zerocopy ? std::make_unique<ZeroCopySends>() : nullptr), last_received(now), last_sent(now)
+        {
+        }
+    };
+
+public:
+    static constexpr int DEFAULT_BATCH = 256;
+
+    /// @param batch `maxevents` of each `epoll_wait()`
+    explicit EpollWorker(int batch = DEFAULT_BATCH, const SessionTimeouts& timeouts = {})
+        : _epoll(epoll_create1(EPOLL_CLOEXEC)), _events(batch), _timeouts(timeouts), _now(Clock::now()),
+          _timers(_now)
+    {
+        if (!_epoll)
+            throw_errno("epoll_create1");
+
+        // `data.ptr == nullptr` 은 inbox
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epoll_ctl(_epoll.get(), EPOLL_CTL_ADD, _inbox.event_fd(), &event))
+            throw_errno("epoll_ctl inbox");
+    }
+
+public:
+    /// Accepts on `listener` too (a `SO_REUSEPORT` one of its own), from `run()`.
+    /// Before `run()`.
+    void accept_on(int listener)
+    {
+        _listener = listener;
+
+        // `data.ptr == this` 는 리스너
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = this;
+        if (epoll_ctl(_epoll.get(), EPOLL_CTL_ADD, listener, &event))
+            throw_errno("epoll_ctl listener");
+    }
+
+    /// Speaks length-prefixed messages, instead of echoing raw bytes.
+    /// Before `run()`.
+    void use_framing()
+    {
+        _framed = true;
+    }
+
+    /// Sends raw echoes of at least `threshold` bytes with `MSG_ZEROCOPY`, on the sockets that support it.
+    /// Not with `use_framing()`, whose replies are at most a message each.
+    /// Before `run()`.
+    void use_zerocopy(std::size_t threshold)
+    {
+        _zerocopy_threshold = threshold;
+    }
+
+    /// Any thread.
+    void add_session(int fd)
+    {
+        _inbox.push(fd);
+    }
+
+    /// Any thread.
+    void stop()
+    {
+        _stopping.store(true);
+        _inbox.wake();
+    }
+
+    auto stats() const -> const WorkerStats&
+    {
+        return _stats;
+    }
+
+    void run()
+    {
+        while (!_stopping.load(std::memory_order_relaxed))
+        {
+            const int count = epoll_wait(_epoll.get(), _events.data(), static_cast<int>(_events.size()), wait_ms());
+            WorkerStats::add(_stats.syscalls);
+            if (count < 0)
+            {
+                if (EINTR == errno)
+                    continue;
+                throw_errno("epoll_wait");
+            }
+
+            // 배치마다 한 번만 시계를 읽고, 세션에는 그 시각을 찍음
+            _now = Clock::now();
+            WorkerStats::add(_stats.waits);
+            WorkerStats::add(_stats.completions, static_cast<std::uint64_t>(count));
+
+            for (int i = 0; i < count; ++i)
+            {
+                const epoll_event& event = _events[i];
+                if (!event.data.ptr)
+                {
+                    accept_inbox();
+                    continue;
+                }
+                if (event.data.ptr == this)
+                {
+                    accept_listener();
+                    continue;
+                }
+
+                auto& session = *static_cast<Session*>(event.data.ptr);
+                session.can_read |= static_cast<bool>(event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP));
+                session.can_write |= static_cast<bool>(event.events & EPOLLOUT);
+
+                // zero-copy 완료 알림도 EPOLLERR 로 옴
+                if ((event.events & EPOLLERR) && !reap_zerocopy(session))
+                    close(session);
+                else if (!(_framed ? echo_messages(session) : echo(session)))
+                    close(session);
+            }
+
+            _timers.advance(_now, [this](TimerWheel::Key key) { return on_timer(key); });
+            if (_accept_paused_until && _now >= *_accept_paused_until)
+                resume_accept();
+        }
+    }
+
+private:
+    void accept_inbox()
+    {
+        _inbox.take(_accepted);
+        for (const int fd : _accepted)
+            open(fd);
+    }
+
+    void accept_listener()
+    {
+        for (;;)
+        {
+            const int fd = accept4(_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            WorkerStats::add(_stats.syscalls);
+            if (fd < 0)
+            {
+                if (is_out_of_resources(errno))
+                    pause_accept();
+                else if (EAGAIN != errno && ECONNABORTED != errno)
+                    throw_errno("accept4");
+                return;
+            }
+
+            WorkerStats::add(_stats.syscalls);
+            if (!set_no_delay(fd))
+            {
+                ::close(fd);
+                continue;
+            }
+            open(fd);
+        }
+    }
+
+    /// Out of fds or memory: takes the listener out of the epoll set, as it's level-triggered and would wake
+    /// this worker right away again, until a session closes or `ACCEPT_BACKOFF` passes.
+    void pause_accept()
+    {
+        WorkerStats::add(_stats.accept_failures);
+        if (_accept_paused_until)
+            return;
+
+        if (epoll_ctl(_epoll.get(), EPOLL_CTL_DEL, _listener, nullptr))
+            throw_errno("epoll_ctl listener");
+        WorkerStats::add(_stats.syscalls);
+        _accept_paused_until = _now + ACCEPT_BACKOFF;
+    }
+
+    void resume_accept()
+    {
+        _accept_paused_until.reset();
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = this;
+        if (epoll_ctl(_epoll.get(), EPOLL_CTL_ADD, _listener, &event))
+            throw_errno("epoll_ctl listener");
+        WorkerStats::add(_stats.syscalls);
+    }
+
+    void open(int fd)
+    {
+        const std::uint32_t serial = _next_serial++;
+        std::size_t buf_size = _framed ? FRAMED_RING_BUF_SIZE : RING_BUF_SIZE;
+        bool zerocopy = false;
+        if (_zerocopy_threshold && !_framed)
+        {
+            // 지원 안 되는 소켓이어도 같은 크기로: 복사와 비교할 수 있게
+            buf_size = ZEROCOPY_RING_BUF_SIZE;
+            zerocopy = ZeroCopySends::enable(fd);
+            WorkerStats::add(_stats.syscalls);
+        }
+        auto session = std::make_unique<Session>(fd, serial, buf_size, _framed, zerocopy, _now);
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = session.get();
+        if (epoll_ctl(_epoll.get(), EPOLL_CTL_ADD, fd, &event))
+            throw_errno("epoll_ctl session");
+
+        _sessions.emplace(fd, std::move(session));
+        WorkerStats::add(_stats.sessions);
+
+        _timers.schedule(timer_key(fd, serial), next_check());
+    }
+
+    /// Echoes until the socket would block both ways.
+    /// @return `false` if the peer closed, or on error
+    bool echo(Session& session)
+    {
+        for (bool progress = true; progress;)
+        {
+            progress = false;
+
+            // 받은 만큼 먼저 돌려보내서, 받을 자리를 만듦
+            if (const IoSegments filled = unsent_segments(session); session.can_write && !filled.empty())
+            {
+                iovec iov[2];
+                // 경로가 어차피 복사하는 세션(루프백 등)은 복사 송신으로 돌아감
+                const bool zerocopy = session.zerocopy && session.zerocopy->worthwhile() &&
+                                      filled.size() >= _zerocopy_threshold;
+                ssize_t sent = zerocopy ? send_zerocopy(session.sock.get(), to_iovecs(filled, iov), filled.count)
+                                        : writev(session.sock.get(), to_iovecs(filled, iov),
+                                                 static_cast<int>(filled.count));
+                WorkerStats::add(_stats.syscalls);
+
+                // 알림이 너무 쌓여 optmem 한도에 걸리면, 이번엔 그냥 복사
+                const bool copied_instead = zerocopy && sent < 0 && ENOBUFS == errno;
+                if (copied_instead)
+                {
+                    sent = writev(session.sock.get(), iov, static_cast<int>(filled.count));
+                    WorkerStats::add(_stats.syscalls);
+                }
+                if (sent < 0 && EAGAIN != errno)
+                    return false;
+
+                if (sent > 0)
+                {
+                    const auto length = static_cast<std::size_t>(sent);
+                    const bool zerocopy_sent = zerocopy && !copied_instead;
+                    session.last_sent = _now;
+                    session.buf.move_read_pos(session.zerocopy ? session.zerocopy->sent(length, zerocopy_sent)
+                                                               : length);
+                    WorkerStats::add(_stats.bytes, static_cast<std::uint64_t>(sent));
+                    WorkerStats::add(_stats.zerocopy_sends, zerocopy_sent ? 1 : 0);
+                    progress = true;
+                }
+                session.can_write = (sent == static_cast<ssize_t>(filled.size()));
+            }
+
+            if (const IoSegments free = free_segments(session.buf); session.can_read && !free.empty())
+            {
+                iovec iov[2];
+                const ssize_t received = readv(session.sock.get(), to_iovecs(free, iov), static_cast<int>(free.count));
+                WorkerStats::add(_stats.syscalls);
+                if (0 == received || (received < 0 && EAGAIN != errno))
+                    return false;
+
+                if (received > 0)
+                {
+                    // 보낼 게 없다가 생겼으면, 여기서부터 송신 정체를 잼
+                    if (unsent_segments(session).empty())
+                        session.last_sent = _now;
+                    session.last_received = _now;
+                    session.buf.move_write_pos(static_cast<std::size_t>(received));
+                    WorkerStats::add(_stats.echoes);
+                    progress = true;
+                }
+                // 덜 찼으면 소켓 수신 버퍼가 비었다는 뜻이니, 다음 엣지까지 기다림
+                session.can_read = (received == static_cast<ssize_t>(free.size()));
+            }
+        }
+        return true;
+    }
+
+    /// `echo()` of the framed protocol: takes the complete messages off the ring buffer, and sends their replies
+    /// in one `writev()`, until the socket would block both ways.
+    /// @return `false` if the peer closed, on error, or if it sent something else than length-prefixed messages
+    bool echo_messages(Session& session)
+    {
+        ReplyBatch& replies = *session.replies;
+        for (bool progress = true; progress;)
+        {
+            progress = false;
+
+            // 지난 답장이 다 나가서 링버퍼를 비운 뒤에만 새로 파싱: 답장이 가리키는 메시지는 그대로 있어야 함
+            if (replies.empty())
+            {
+                FrameParser parser(filled_segments(session.buf));
+                while (!replies.full())
+                {
+                    const std::optional<IoSegments> message = parser.next();
+                    if (!message)
+                        break;
+                    on_message(*message, replies);
+                }
+                if (parser.malformed())
+                    return false;
+
+                session.replied = parser.parsed();
+                if (!replies.empty())
+                    session.last_sent = _now;
+            }
+
+            if (session.can_write && !replies.empty())
+            {
+                iovec iov[ReplyBatch::MAX_PIECES];
+                const std::span<const ReplyBatch::Piece> pieces = replies.pieces();
+                for (std::size_t i = 0; i < pieces.size(); ++i)
+                    iov[i] = {const_cast<std::byte*>(pieces[i].data()), pieces[i].size()};
+
+                const std::size_t size = replies.size();
+                const ssize_t sent = writev(session.sock.get(), iov, static_cast<int>(pieces.size()));
+                WorkerStats::add(_stats.syscalls);
+                if (sent < 0 && EAGAIN != errno)
+                    return false;
+
+                if (sent > 0)
+                {
+                    session.last_sent = _now;
+                    replies.consume(static_cast<std::size_t>(sent));
+                    WorkerStats::add(_stats.bytes, static_cast<std::uint64_t>(sent));
+                    if (replies.empty())
+                        session.buf.move_read_pos(std::exchange(session.replied, 0));
+                    progress = true;
+                }
+                session.can_write = (sent == static_cast<ssize_t>(size));
+            }
+
+            if (const IoSegments free = free_segments(session.buf); session.can_read && !free.empty())
+            {
+                iovec iov[2];
+                const ssize_t received = readv(session.sock.get(), to_iovecs(free, iov), static_cast<int>(free.count));
+                WorkerStats::add(_stats.syscalls);
+                if (0 == received || (received < 0 && EAGAIN != errno))
+                    return false;
+
+                if (received > 0)
+                {
+                    session.last_received = _now;
+                    session.buf.move_write_pos(static_cast<std::size_t>(received));
+                    WorkerStats::add(_stats.echoes);
+                    progress = true;
+                }
+                session.can_read = (received == static_cast<ssize_t>(free.size()));
+            }
+        }
+        return true;
+    }
+
+    /// Handles one message of the framed protocol, still in place on the ring buffer.
+    void on_message(const IoSegments& message, ReplyBatch& replies)
+    {
+        // 에코: 답장은 메시지 그 자체
+        replies.add(message);
+        WorkerStats::add(_stats.messages);
+    }
+
+    /// Releases the ring buffer space of the zero-copy sends the kernel is done with.
+    /// @return `false` if there's a real error on the socket instead
+    bool reap_zerocopy(Session& session)
+    {
+        if (!session.zerocopy)
+            return false;
+
+        const std::optional<ZeroCopySends::Reaped> reaped = session.zerocopy->reap(session.sock.get());
+        if (!reaped)
+            return false;
+
+        session.buf.move_read_pos(reaped->released);
+        WorkerStats::add(_stats.syscalls, reaped->syscalls);
+        WorkerStats::add(_stats.zerocopy_completed, reaped->completed);
+        WorkerStats::add(_stats.zerocopy_copied, reaped->copied);
+
+        // 알림 없이 EPOLLERR 만 왔으면 소켓 에러
+        return 0 != reaped->completed;
+    }
+
+    /// Received bytes not sent yet: after the zero-copy sends in flight, if any.
+    static auto unsent_segments(Session& session) -> IoSegments
+    {
+        const IoSegments filled = filled_segments(session.buf);
+        if (!session.zerocopy || 0 == session.zerocopy->in_flight())
+            return filled;
+
+        const std::size_t in_flight = session.zerocopy->in_flight();
+        return slice(filled, in_flight, filled.size() - in_flight);
+    }
+
+    static auto send_zerocopy(int fd, iovec* iov, std::size_t count) -> ssize_t
+    {
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        return sendmsg(fd, &msg, MSG_ZEROCOPY);
+    }
+
+    void close(Session& session)
+    {
+        // 커널이 아직 링버퍼를 읽고 있으면, 세션과 함께 버퍼가 해제되기 전에 연결을 끊어 보내던 걸 버리게 함
+        if (session.zerocopy && session.zerocopy->pending())
+        {
+            const linger abort{1, 0};
+            setsockopt(session.sock.get(), SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+        }
+
+        // 소켓을 닫으면 epoll 에서도 빠짐
+        _sessions.erase(session.sock.get());
+
+        // fd 가 하나 났으니 accept 재개
+        if (_accept_paused_until)
+            _accept_paused_until = _now;
+    }
+
+    static auto timer_key(int fd, std::uint32_t serial) -> TimerWheel::Key
+    {
+        return (static_cast<TimerWheel::Key>(serial) << 32) | static_cast<std::uint32_t>(fd);
+    }
+
+    /// Closes the session of `key` if it's been idle or stalled for too long, or tells when to check again.
+    auto on_timer(TimerWheel::Key key) -> std::optional<Clock::time_point>
+    {
+        const auto found = _sessions.find(static_cast<int>(static_cast<std::uint32_t>(key)));
+        if (found == _sessions.end() || found->second->serial != static_cast<std::uint32_t>(key >> 32))
+            return std::nullopt;
+
+        // 프레임 모드에선 덜 온 메시지가 남아있어도, 보낼 답장이 없으면 쉬는 중
+        Session& session = *found->second;
+        const bool echoing = session.replies ? !session.replies->empty() : session.buf.used_space() > 0;
+        const Clock::time_point deadline =
+            echoing ? session.last_sent + _timeouts.write_stall : session.last_received + _timeouts.idle;
+        if (_now < deadline)
+            return std::min(deadline, next_check());
+
+        WorkerStats::add(echoing ? _stats.stall_timeouts : _stats.idle_timeouts);
+        close(session);
+        return std::nullopt;
+    }
+
+    /// Latest time to look at a session again, as it may start stalling anytime: a stall is noticed
+    /// within twice its timeout.
+    auto next_check() const -> Clock::time_point
+    {
+        return _now + std::min(_timeouts.idle, _timeouts.write_stall);
+    }
+
+    /// `epoll_wait()` timeout: until the next tick of the timer wheel, or forever without any session,
+    /// but no later than resuming a paused accept.
+    auto wait_ms() const -> int
+    {
+        const Clock::time_point now = Clock::now();
+        std::optional<Clock::duration> wait = _timers.until_next_tick(now);
+        if (_accept_paused_until)
+            wait = std::min(wait.value_or(Clock::duration::max()),
+                            std::max(*_accept_paused_until - now, Clock::duration::zero()));
+        return wait ? static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(*wait).count()) : -1;
+    }
+
+    static auto to_iovecs(const IoSegments& segments, iovec (&iov)[2]) -> iovec*
+    {
+        for (std::size_t i = 0; i < segments.count; ++i)
+            iov[i] = {segments.parts[i].data(), segments.parts[i].size()};
+        return iov;
+    }
+
+private:
+    UniqueFd _epoll;
+    int _listener = -1;
+    std::optional<Clock::time_point> _accept_paused_until;
+    SessionInbox _inbox;
+    std::vector<epoll_event> _events;
+    std::vector<int> _accepted;
+
+    std::unordered_map<int, std::unique_ptr<Session>> _sessions;
+    std::uint32_t _next_serial = 0;
+    bool _framed = false;
+    std::size_t _zerocopy_threshold = 0; // 0: always copy
+
+    const SessionTimeouts _timeouts;
+    Clock::time_point _now; // as of the last `epoll_wait()`
+    TimerWheel _timers;
+
+    std::atomic<bool> _stopping = false;
+    WorkerStats _stats;
+};
+
+/// Accepts on the main thread: `poll()` on the listener, then `accept4()` until it would block.
+///
+/// Out of fds or memory, it stops accepting for `ACCEPT_BACKOFF`, as the listener would be readable right away again.
+class PollAcceptor
+{
+public:
+    explicit PollAcceptor(int listener) : _listener(listener)
+    {
+    }
+
+public:
+    /// Waits up to `timeout_ms` for new connections, and appends them to `socks`.
+    void accept(std::vector<int>& socks, int timeout_ms)
+    {
+        pollfd listening{_listener, POLLIN, 0};
+        if (poll(&listening, 1, timeout_ms) <= 0)
+            return;
+
+        for (;;)
+        {
+            const int sock = accept4(_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (sock < 0)
+            {
+                if (is_out_of_resources(errno))
+                {
+                    std::cout << std::format("accept4: {}, backing off\n", std::strerror(errno));
+                    std::this_thread::sleep_for(ACCEPT_BACKOFF);
+                }
+                else if (EAGAIN != errno && ECONNABORTED != errno)
+                {
+                    throw_errno("accept4");
+                }
+                return;
+            }
+            socks.push_back(sock);
+        }
+    }
+
+private:
+    const int _listener;
+};
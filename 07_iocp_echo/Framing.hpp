@@ -0,0 +1,225 @@
+#pragma once
+
+#include "IoSegments.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/// Length-prefixed messages: each is its length as a varint (7 bits per byte, lowest first,
+/// the top bit set on every byte but the last), then that many bytes.
+///
+/// Messages are parsed in place on the session ring buffer, and their replies point into it too,
+/// so a message is never copied on its way from the receive to the send.
+
+static constexpr std::size_t MAX_FRAME_HEADER_SIZE = 3;
+static constexpr std::size_t MAX_MESSAGE_SIZE = 8 * 1024;
+
+/// Writes the length prefix of a `length` bytes message to `out`.
+/// @return size of the prefix
+inline auto write_frame_header(std::size_t length, std::byte* out) -> std::size_t
+{
+    assert(length <= MAX_MESSAGE_SIZE);
+
+    std::size_t size = 0;
+    for (; length >= 0x80; length >>= 7)
+        out[size++] = static_cast<std::byte>(0x80 | (length & 0x7F));
+    out[size++] = static_cast<std::byte>(length);
+    return size;
+}
+
+/// `length` bytes of `segments` from `offset`, still in place.
+inline auto slice(const IoSegments& segments, std::size_t offset, std::size_t length) -> IoSegments
+{
+    IoSegments sliced;
+    for (std::size_t i = 0; i < segments.count && length > 0; ++i)
+    {
+        const std::span<std::byte> part = segments.parts[i];
+        if (offset >= part.size())
+        {
+            offset -= part.size();
+            continue;
+        }
+
+        const std::size_t taken = std::min(length, part.size() - offset);
+        sliced.parts[sliced.count++] = part.subspan(offset, taken);
+        offset = 0;
+        length -= taken;
+    }
+    return sliced;
+}
+
+/// Takes complete messages off the front of received bytes, without copying them.
+class FrameParser
+{
+public:
+    explicit FrameParser(const IoSegments& received) : _received(received), _size(received.size())
+    {
+    }
+
+public:
+    /// Next complete message, still in place (in two parts, if it wraps around the ring buffer).
+    /// @return `std::nullopt` if what's left is only part of one, or it's `malformed()`
+    auto next() -> std::optional<IoSegments>
+    {
+        if (_malformed)
+            return std::nullopt;
+
+        // 길이가 아직 다 안 왔으면 다음 수신을 기다림
+        std::size_t length = 0;
+        std::size_t header = 0;
+        for (;; ++header)
+        {
+            if (header == MAX_FRAME_HEADER_SIZE)
+            {
+                _malformed = true;
+                return std::nullopt;
+            }
+            if (_parsed + header == _size)
+                return std::nullopt;
+
+            const auto byte = static_cast<std::uint8_t>(byte_at(_parsed + header));
+            length |= static_cast<std::size_t>(byte & 0x7F) << (7 * header);
+            if (!(byte & 0x80))
+                break;
+        }
+        ++header;
+
+        if (length > MAX_MESSAGE_SIZE)
+        {
+            _malformed = true;
+            return std::nullopt;
+        }
+        if (_size - _parsed - header < length)
+            return std::nullopt;
+
+        const IoSegments message = slice(_received, _parsed + header, length);
+        _parsed += header + length;
+        return message;
+    }
+
+    /// Bytes of the messages taken so far, prefixes included.
+    auto parsed() const -> std::size_t
+    {
+        return _parsed;
+    }
+
+    /// A prefix too long, or a message over `MAX_MESSAGE_SIZE`: the peer doesn't speak this protocol.
+    bool malformed() const
+    {
+        return _malformed;
+    }
+
+private:
+    auto byte_at(std::size_t offset) const -> std::byte
+    {
+        const std::span<std::byte> first = _received.parts[0];
+        return (offset < first.size()) ? first[offset] : _received.parts[1][offset - first.size()];
+    }
+
+private:
+    const IoSegments _received;
+    const std::size_t _size;
+    std::size_t _parsed = 0;
+    bool _malformed = false;
+};
+
+/// Replies gathered for one scatter/gather send (`writev()`, `WSASend()`): each one's length prefix
+/// from the batch's own little arena, then its message wherever it lives, typically still in the receive ring buffer.
+///
+/// The messages must stay put until the whole batch is sent: release their ring buffer space only then.
+class ReplyBatch
+{
+public:
+    // `IOV_MAX` 는 1024 지만, 수십 조각을 넘기면 더 모아봐야 시스템 콜당 비용이 거의 안 줄어듦
+    static constexpr std::size_t MAX_PIECES = 64;
+
+    using Piece = std::span<const std::byte>;
+
+public:
+    bool empty() const
+    {
+        return _first == _count;
+    }
+
+    /// No room for one more reply: a prefix, and a message in up to 2 parts.
+    bool full() const
+    {
+        return _count + 3 > MAX_PIECES;
+    }
+
+    /// Bytes not sent yet.
+    auto size() const -> std::size_t
+    {
+        return _size;
+    }
+
+    /// Pieces not sent yet, in order.
+    auto pieces() const -> std::span<const Piece>
+    {
+        return std::span(_pieces.data() + _first, _count - _first);
+    }
+
+    /// Queues `message` as a reply, without copying it.
+    void add(const IoSegments& message)
+    {
+        assert(!full());
+
+        std::byte* const header = _headers.data() + _headers_used;
+        const std::size_t header_size = write_frame_header(message.size(), header);
+        _headers_used += header_size;
+        push(Piece(header, header_size));
+
+        for (std::size_t i = 0; i < message.count; ++i)
+            push(message.parts[i]);
+    }
+
+    /// Drops the first `length` bytes, sent (maybe in the middle of a piece).
+    void consume(std::size_t length)
+    {
+        assert(length <= _size);
+        _size -= length;
+
+        for (; length > 0; ++_first)
+        {
+            Piece& piece = _pieces[_first];
+            if (length < piece.size())
+            {
+                piece = piece.subspan(length);
+                break;
+            }
+            length -= piece.size();
+        }
+
+        if (empty())
+            clear();
+    }
+
+    void clear()
+    {
+        _first = _count = 0;
+        _headers_used = 0;
+        _size = 0;
+    }
+
+private:
+    void push(Piece piece)
+    {
+        _pieces[_count++] = piece;
+        _size += piece.size();
+    }
+
+private:
+    std::array<Piece, MAX_PIECES> _pieces;
+    std::size_t _first = 0;
+    std::size_t _count = 0;
+    std::size_t _size = 0;
+
+    // 답장마다 조각이 2개 이상이니, 접두어 자리는 절반이면 충분
+    std::array<std::byte, MAX_PIECES / 2 * MAX_FRAME_HEADER_SIZE> _headers;
+    std::size_t _headers_used = 0;
+};
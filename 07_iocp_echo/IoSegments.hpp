@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+/// Up to 2 contiguous spans of a session ring buffer, for one scatter/gather I/O call
+/// (`WSASend()`/`WSARecv()`, `readv()`/`writev()`).
+struct IoSegments
+{
+    std::span<std::byte> parts[2];
+    std::size_t count = 0;
+
+    auto size() const -> std::size_t
+    {
+        return parts[0].size() + parts[1].size();
+    }
+
+    bool empty() const
+    {
+        return 0 == count;
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "linux_common.hpp"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+/// Minimal io_uring instance over the raw syscalls (no liburing).
+///
+/// Single issuer: only the thread that called `enable()` may queue, submit and reap.
+/// Until then, any thread may register resources with it.
+/// SQEs are queued with `get_sqe()` and all go to the kernel in the next `submit_and_wait()`,
+/// so one loop iteration costs one `io_uring_enter()` no matter how many operations it posts.
+class IoUring
+{
+public:
+    /// @param entries SQ size; the CQ is `cq_factor` times as large, as multishot operations post many CQEs per SQE
+    explicit IoUring(unsigned entries, unsigned cq_factor = 4)
+    {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER |
+                       IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_R_DISABLED;
+        params.cq_entries = entries * cq_factor;
+        _fd.reset(setup(entries, params));
+
+        // 6.1 이전 커널은 위 플래그들을 모름
+        if (!_fd && EINVAL == errno)
+        {
+            params = {};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = entries * cq_factor;
+            _fd.reset(setup(entries, params));
+        }
+        if (!_fd)
+            throw_errno("io_uring_setup");
+
+        _disabled = params.flags & IORING_SETUP_R_DISABLED;
+        _features = params.features;
+        if (!(_features & IORING_FEAT_SINGLE_MMAP))
+            throw std::system_error(ENOSYS, std::system_category(), "io_uring without IORING_FEAT_SINGLE_MMAP");
+
+        // SQ 와 CQ 링은 한 매핑을 공유
+        _ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(std::uint32_t),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        _ring = map(_ring_size, IORING_OFF_SQ_RING);
+        _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        _sqes = static_cast<io_uring_sqe*>(map(_sqes_size, IORING_OFF_SQES));
+
+        _sq_head = at<std::uint32_t>(params.sq_off.head);
+        _sq_tail = at<std::uint32_t>(params.sq_off.tail);
+        _sq_mask = *at<std::uint32_t>(params.sq_off.ring_mask);
+        _sq_entries = params.sq_entries;
+        _cq_head = at<std::uint32_t>(params.cq_off.head);
+        _cq_tail = at<std::uint32_t>(params.cq_off.tail);
+        _cq_mask = *at<std::uint32_t>(params.cq_off.ring_mask);
+        _cqes = at<io_uring_cqe>(params.cq_off.cqes);
+
+        // SQE 는 항상 순서대로 쓰니, SQ 배열은 항등 매핑으로 한 번만 채움
+        auto* const array = at<std::uint32_t>(params.sq_off.array);
+        for (std::uint32_t i = 0; i < _sq_entries; ++i)
+            array[i] = i;
+
+        _local_sq_tail = *_sq_tail;
+    }
+
+    ~IoUring()
+    {
+        if (_sqes)
+            munmap(_sqes, _sqes_size);
+        if (_ring)
+            munmap(_ring, _ring_size);
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+public:
+    auto fd() const -> int
+    {
+        return _fd.get();
+    }
+
+    auto features() const -> std::uint32_t
+    {
+        return _features;
+    }
+
+    /// `io_uring_enter()` and `io_uring_register()` calls so far.
+    auto syscalls() const -> std::uint64_t
+    {
+        return _syscalls;
+    }
+
+    /// Makes the calling thread the one that submits.
+    void enable()
+    {
+        if (!_disabled)
+            return;
+        if (const int error = register_op(IORING_REGISTER_ENABLE_RINGS, nullptr, 0); error < 0)
+            throw std::system_error(-error, std::system_category(), "IORING_REGISTER_ENABLE_RINGS");
+        _disabled = false;
+    }
+
+public: // Submission
+    /// Zeroed SQE to fill in, submitted on the next `submit_and_wait()`.
+    /// If the SQ is full, submits the queued ones first.
+    auto get_sqe() -> io_uring_sqe*
+    {
+        if (_local_sq_tail - std::atomic_ref(*_sq_head).load(std::memory_order_acquire) >= _sq_entries)
+            submit_and_wait(0);
+
+        io_uring_sqe* const sqe = &_sqes[_local_sq_tail & _sq_mask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++_local_sq_tail;
+        return sqe;
+    }
+
+    /// Submits the queued SQEs, and waits until at least `wait_nr` CQEs are ready.
+    /// @param timeout_ns with `wait_nr > 0`, gives up waiting after this long (negative: no timeout)
+    /// @return `false` on timeout or signal
+    bool submit_and_wait(unsigned wait_nr, std::int64_t timeout_ns = -1)
+    {
+        const unsigned to_submit = _local_sq_tail - *_sq_tail;
+        std::atomic_ref(*_sq_tail).store(_local_sq_tail, std::memory_order_release);
+
+        unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+        __kernel_timespec ts{};
+        io_uring_getevents_arg arg{};
+        const void* argp = nullptr;
+        std::size_t argsz = 0;
+        if (wait_nr && timeout_ns >= 0)
+        {
+            ts.tv_sec = timeout_ns / 1'000'000'000;
+            ts.tv_nsec = timeout_ns % 1'000'000'000;
+            arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+            flags |= IORING_ENTER_EXT_ARG;
+            argp = &arg;
+            argsz = sizeof(arg);
+        }
+
+        ++_syscalls;
+        if (syscall(__NR_io_uring_enter, _fd.get(), to_submit, wait_nr, flags, argp, argsz) < 0)
+        {
+            if (ETIME == errno || EINTR == errno)
+                return false;
+            throw_errno("io_uring_enter");
+        }
+        return true;
+    }
+
+public: // Completion
+    /// Calls `handler(const io_uring_cqe&)` for every CQE ready, up to `max`, then frees them.
+    /// @return number of CQEs handled
+    template <typename Handler>
+    auto for_each_cqe(Handler&& handler, unsigned max = UINT_MAX) -> unsigned
+    {
+        std::uint32_t head = *_cq_head;
+        const unsigned count = std::min(std::atomic_ref(*_cq_tail).load(std::memory_order_acquire) - head, max);
+        const std::uint32_t tail = head + count;
+
+        for (; head != tail; ++head)
+            handler(_cqes[head & _cq_mask]);
+
+        std::atomic_ref(*_cq_head).store(head, std::memory_order_release);
+        return count;
+    }
+
+public: // Registration
+    /// `io_uring_register()`.
+    /// @return `0`, or `-errno` on failure
+    auto register_op(unsigned opcode, const void* arg, unsigned nr_args) -> int
+    {
+        ++_syscalls;
+        return (syscall(__NR_io_uring_register, _fd.get(), opcode, arg, nr_args) < 0) ? -errno : 0;
+    }
+
+    /// Whether the kernel knows the `IORING_OP_*` `opcode`.
+    bool supports(std::uint8_t opcode)
+    {
+        constexpr unsigned OPS = 256;
+        const auto probe_size = sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op);
+        const auto storage = std::make_unique<std::byte[]>(probe_size);
+        auto* const probe = reinterpret_cast<io_uring_probe*>(storage.get());
+
+        if (register_op(IORING_REGISTER_PROBE, probe, OPS) < 0 || opcode > probe->last_op)
+            return false;
+        return probe->ops[opcode].flags & IO_URING_OP_SUPPORTED;
+    }
+
+private:
+    static auto setup(unsigned entries, io_uring_params& params) -> int
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    auto map(std::size_t size, off_t offset) -> void*
+    {
+        void* const addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd.get(), offset);
+        if (MAP_FAILED == addr)
+            throw_errno("mmap io_uring");
+        return addr;
+    }
+
+    template <typename T>
+    auto at(std::uint32_t offset) -> T*
+    {
+        return reinterpret_cast<T*>(static_cast<std::byte*>(_ring) + offset);
+    }
+
+private:
+    UniqueFd _fd;
+    std::uint32_t _features = 0;
+    bool _disabled = false;
+
+    void* _ring = nullptr;
+    std::size_t _ring_size = 0;
+    io_uring_sqe* _sqes = nullptr;
+    std::size_t _sqes_size = 0;
+
+    std::uint32_t* _sq_head;
+    std::uint32_t* _sq_tail;
+    std::uint32_t _sq_mask;
+    std::uint32_t _sq_entries;
+    std::uint32_t _local_sq_tail;
+
+    std::uint32_t* _cq_head;
+    std::uint32_t* _cq_tail;
+    std::uint32_t _cq_mask;
+    io_uring_cqe* _cqes;
+
+    std::uint64_t _syscalls = 0;
+};
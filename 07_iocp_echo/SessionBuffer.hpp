@@ -0,0 +1,167 @@
+#pragma once
+
+#include "BufferPool.hpp"
+#include "IoSegments.hpp"
+
+#include <NetBuff/RingByteBuffer.hpp>
+#include <vtp/MirroredRingBuffer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <span>
+
+static constexpr std::size_t RING_BUF_SIZE = 2048;
+
+// 미러링된 링버퍼는 항상 한 덩어리로 송수신 (대신 버퍼 크기가 64 KiB 단위로 올림됨)
+#if defined(VTP_MIRRORED_RING_BUFFER)
+using SessionBuffer = vtp::MirroredRingBuffer;
+#else
+using SessionBuffer = nb::RingByteBuffer<>;
+#endif
+
+/// Whole memory of `buf` that I/O may address, e.g. to register it with the kernel.
+inline auto storage_span(SessionBuffer& buf) -> std::span<std::byte>
+{
+#if defined(VTP_MIRRORED_RING_BUFFER)
+    // 두 번째 매핑까지 포함해야 경계를 넘는 구간도 그대로 가리킴
+    return std::span(buf.data(), 2 * buf.capacity());
+#else
+    // 가득 찬 것과 빈 것을 구분하는 1 바이트 여유 포함
+    return std::span(buf.data(), buf.capacity() + 1);
+#endif
+}
+
+/// Received bytes, waiting to be echoed back.
+template <typename Buffer>
+auto filled_segments(Buffer& buf) -> IoSegments
+{
+    IoSegments segments;
+    const std::size_t used = buf.used_space();
+    if (0 == used)
+        return segments;
+
+    const std::size_t consecutive = buf.consecutive_read_length();
+    segments.parts[0] = std::span(buf.data() + buf.read_pos(), consecutive);
+    segments.count = 1;
+    if (used > consecutive)
+    {
+        segments.parts[1] = std::span(buf.data(), used - consecutive);
+        segments.count = 2;
+    }
+    return segments;
+}
+
+/// Free space to receive into.
+template <typename Buffer>
+auto free_segments(Buffer& buf) -> IoSegments
+{
+    IoSegments segments;
+    const std::size_t available = buf.available_space();
+    if (0 == available)
+        return segments;
+
+    const std::size_t consecutive = buf.consecutive_write_length();
+    segments.parts[0] = std::span(buf.data() + buf.write_pos(), consecutive);
+    segments.count = 1;
+    if (available > consecutive)
+    {
+        segments.parts[1] = std::span(buf.data(), available - consecutive);
+        segments.count = 2;
+    }
+    return segments;
+}
+
+/// Session ring buffer shared by a receive and a send in flight at the same time, on different threads.
+///
+/// Each direction has its own cursor, a running byte count: only the receive side advances `_received`,
+/// and only the send side advances `_sent` (single producer, single consumer).
+///
+/// Its memory is borrowed from `BufferPool` only while there's data to hold: `attach()` before receiving,
+/// and `detach()` once everything is sent. Detached, it has no room at all.
+/// Attaching and detaching race both sides, so the owner must make sure neither is using it meanwhile.
+class DuplexSessionBuffer
+{
+public:
+    bool attached() const
+    {
+        return static_cast<bool>(_buf);
+    }
+
+    /// Everything received was sent.
+    bool empty() const
+    {
+        return _received.load() == _sent.load();
+    }
+
+    auto capacity() const -> std::size_t
+    {
+        return _capacity;
+    }
+
+    void attach(std::size_t size_class)
+    {
+        assert(!attached() && empty());
+        _buf = BufferPool::instance().acquire(size_class);
+        _capacity = _buf.size();
+    }
+
+    void detach()
+    {
+        assert(empty());
+        _buf.reset();
+        _capacity = 0;
+    }
+
+public: // Receive side
+    auto free_segments() -> IoSegments
+    {
+        const std::size_t received = _received.load(std::memory_order_relaxed);
+        return segments(received, _capacity - (received - _sent.load()));
+    }
+
+    void commit_received(std::size_t length)
+    {
+        _received.store(_received.load(std::memory_order_relaxed) + length);
+    }
+
+public: // Send side
+    auto filled_segments() -> IoSegments
+    {
+        const std::size_t sent = _sent.load(std::memory_order_relaxed);
+        return segments(sent, _received.load() - sent);
+    }
+
+    void commit_sent(std::size_t length)
+    {
+        _sent.store(_sent.load(std::memory_order_relaxed) + length);
+    }
+
+private:
+    auto segments(std::size_t total, std::size_t length) -> IoSegments
+    {
+        IoSegments segments;
+        if (0 == length)
+            return segments;
+
+        const std::size_t pos = total % _capacity;
+        const std::size_t consecutive = std::min(length, _capacity - pos);
+        segments.parts[0] = std::span(_buf.data() + pos, consecutive);
+        segments.count = 1;
+        if (length > consecutive)
+        {
+            segments.parts[1] = std::span(_buf.data(), length - consecutive);
+            segments.count = 2;
+        }
+        return segments;
+    }
+
+private:
+    PooledBuffer _buf;
+    std::size_t _capacity = 0;
+
+    // 한쪽의 커밋과 다른 쪽의 in-flight 플래그 확인이 엇갈리지 않도록 seq_cst
+    std::atomic<std::size_t> _received = 0;
+    std::atomic<std::size_t> _sent = 0;
+};
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+/// `generation << 32 | index` of a `SessionTable` slot.
+using SessionId = std::uint64_t;
+
+/// Fixed-capacity table of reference-counted sessions, preallocated as one contiguous slot array.
+///
+/// - Lookup by id is a plain index, without any lock.
+/// - Each slot has a generation, bumped when the session is created and when its last reference is dropped
+///   (odd while live), so an id outliving its session, e.g. in a stale completion, no longer matches.
+/// - Generation and reference count share one atomic word, so `acquire()` by id either takes a reference
+///   on that very session, or fails; it never revives one already on its way out.
+/// - A session whose last reference is dropped is `retire()`d, and only destroyed later by `reclaim()`,
+///   which is when its slot goes back to the free index stack (lock-free, its head tagged against ABA).
+///
+/// Slot memory is never freed while the table lives, so reading the state of a recycled slot is always safe.
+template <typename T>
+class SessionTable
+{
+private:
+    static constexpr std::uint32_t NIL = UINT32_MAX;
+
+    struct Slot
+    {
+        std::atomic<std::uint64_t> state = 0; // `generation << 32 | refs`
+        alignas(T) std::byte storage[sizeof(T)];
+
+        auto get() -> T*
+        {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+public:
+    explicit SessionTable(std::uint32_t capacity)
+        : _capacity(capacity), _slots(std::make_unique<Slot[]>(capacity)),
+          _next(std::make_unique<std::atomic<std::uint32_t>[]>(capacity))
+    {
+        assert(capacity < NIL);
+
+        // 낮은 번호부터 쓰도록 역순으로 쌓음
+        for (std::uint32_t i = capacity; i > 0; --i)
+            push_free(i - 1);
+    }
+
+    ~SessionTable()
+    {
+        reclaim();
+        for (std::uint32_t i = 0; i < _capacity; ++i)
+        {
+            if (is_live(generation_of(_slots[i].state.load())))
+                _slots[i].get()->~T();
+        }
+    }
+
+    SessionTable(const SessionTable&) = delete;
+    SessionTable& operator=(const SessionTable&) = delete;
+
+public:
+    auto capacity() const -> std::uint32_t
+    {
+        return _capacity;
+    }
+
+    /// Retired sessions waiting for `reclaim()`.
+    auto retired_count() const -> std::uint32_t
+    {
+        return _retired_count.load(std::memory_order_relaxed);
+    }
+
+public: // Lifetime
+    /// Constructs `T(id, args...)` in a free slot, holding one reference for the caller.
+    /// If there's none, reclaims the retired sessions first, or waits for the thread already reclaiming them.
+    /// @return the new session, or `nullptr` if the table is full
+    template <typename... Args>
+    auto emplace(Args&&... args) -> T*
+    {
+        std::optional<std::uint32_t> index = pop_free();
+
+        // 회수 대기 중인 세션이 남아있으면 꽉 찬 게 아님
+        // (`retired_count()` 는 `retire()` 로 쌓인 것과, 회수 중인 스레드가 아직 다 돌려놓지 못한 것을 셈)
+        while (!index && retired_count() > 0)
+        {
+            if (!_reclaiming.test_and_set(std::memory_order_acquire))
+                reclaim_locked();
+            else
+                _reclaiming.wait(true, std::memory_order_acquire);
+            index = pop_free();
+        }
+        if (!index)
+            return nullptr;
+
+        Slot& slot = _slots[*index];
+        const std::uint32_t generation = generation_of(slot.state.load(std::memory_order_relaxed)) + 1;
+        T* const session = ::new (slot.storage) T(make_id(*index, generation), std::forward<Args>(args)...);
+        slot.state.store(make_state(generation, 1), std::memory_order_release);
+        return session;
+    }
+
+    /// Takes a reference on the session of `id`, if it's still alive.
+    /// @return the session, or `nullptr` if it's gone (or the id is stale)
+    auto acquire(SessionId id) -> T*
+    {
+        Slot* const slot = slot_of(id);
+        if (!slot)
+            return nullptr;
+
+        std::uint64_t state = slot->state.load(std::memory_order_acquire);
+        do
+        {
+            if (generation_of(state) != generation_of(id) || 0 == refs_of(state))
+                return nullptr;
+        } while (!slot->state.compare_exchange_weak(state, state + 1, std::memory_order_acquire));
+
+        return slot->get();
+    }
+
+    /// Takes one more reference, for a caller that already holds one (e.g. to post another I/O).
+    void add_ref(SessionId id)
+    {
+        [[maybe_unused]] const std::uint64_t state = slot_of(id)->state.fetch_add(1, std::memory_order_relaxed);
+        assert(generation_of(state) == generation_of(id) && refs_of(state) > 0);
+    }
+
+    /// Drops a reference.
+    /// @return `true` if it was the last one: the session can't be found anymore, and the caller, its sole owner now,
+    /// must finish it off and `retire()` it
+    bool release(SessionId id)
+    {
+        Slot& slot = *slot_of(id);
+        std::uint64_t state = slot.state.load(std::memory_order_relaxed);
+        std::uint64_t next;
+        do
+        {
+            assert(generation_of(state) == generation_of(id) && refs_of(state) > 0);
+
+            // 마지막 참조면 세대를 올려서, 이후의 `acquire()` 와 `find()` 가 실패하게 함
+            next = (1 == refs_of(state)) ? make_state(generation_of(state) + 1, 0) : state - 1;
+        } while (!slot.state.compare_exchange_weak(state, next, std::memory_order_acq_rel));
+
+        return 0 == refs_of(next);
+    }
+
+    /// Queues the session of `id` (whose last reference was dropped) for destruction on the next `reclaim()`.
+    void retire(SessionId id)
+    {
+        const std::uint32_t index = index_of(id);
+        std::uint32_t head = _retired_head.load(std::memory_order_relaxed);
+        do
+        {
+            _next[index].store(head, std::memory_order_relaxed);
+        } while (!_retired_head.compare_exchange_weak(head, index, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+        _retired_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Destroys the retired sessions, and frees their slots.
+    /// Any thread; if another thread is already at it, returns right away.
+    /// @return number of sessions reclaimed
+    auto reclaim() -> std::uint32_t
+    {
+        if (_reclaiming.test_and_set(std::memory_order_acquire))
+            return 0;
+        return reclaim_locked();
+    }
+
+public: // Lookup
+    /// The session of `id`, without taking a reference: the caller must already hold one.
+    /// @return `nullptr` if it's gone (or the id is stale)
+    auto find(SessionId id) -> T*
+    {
+        Slot* const slot = slot_of(id);
+        if (!slot || generation_of(slot->state.load(std::memory_order_acquire)) != generation_of(id))
+            return nullptr;
+        return slot->get();
+    }
+
+private:
+    /// `reclaim()`, holding `_reclaiming`; releases it.
+    auto reclaim_locked() -> std::uint32_t
+    {
+        // 통째로 떼어내므로 ABA 걱정 없음
+        std::uint32_t count = 0;
+        for (std::uint32_t index = _retired_head.exchange(NIL, std::memory_order_acquire); NIL != index; ++count)
+        {
+            const std::uint32_t next = _next[index].load(std::memory_order_relaxed);
+            _slots[index].get()->~T();
+            push_free(index);
+            index = next;
+        }
+        _retired_count.fetch_sub(count, std::memory_order_relaxed);
+
+        _reclaiming.clear(std::memory_order_release);
+        _reclaiming.notify_all();
+        return count;
+    }
+
+    auto slot_of(SessionId id) -> Slot*
+    {
+        const std::uint32_t index = index_of(id);
+        return (index < _capacity) ? &_slots[index] : nullptr;
+    }
+
+    static auto make_id(std::uint32_t index, std::uint32_t generation) -> SessionId
+    {
+        return (static_cast<SessionId>(generation) << 32) | index;
+    }
+
+    static auto make_state(std::uint32_t generation, std::uint32_t refs) -> std::uint64_t
+    {
+        return (static_cast<std::uint64_t>(generation) << 32) | refs;
+    }
+
+    static auto index_of(SessionId id) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(id);
+    }
+
+    static auto generation_of(std::uint64_t id_or_state) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(id_or_state >> 32);
+    }
+
+    static auto refs_of(std::uint64_t state) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(state);
+    }
+
+    static bool is_live(std::uint32_t generation)
+    {
+        return generation & 1;
+    }
+
+private: // Free index stack, head is `tag << 32 | index`
+    void push_free(std::uint32_t index)
+    {
+        std::uint64_t head = _free_head.load(std::memory_order_relaxed);
+        do
+        {
+            _next[index].store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+        } while (!_free_head.compare_exchange_weak(head, next_head(head, index), std::memory_order_release,
+                                                   std::memory_order_relaxed));
+    }
+
+    auto pop_free() -> std::optional<std::uint32_t>
+    {
+        std::uint64_t head = _free_head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const auto index = static_cast<std::uint32_t>(head);
+            if (NIL == index)
+                return std::nullopt;
+
+            // 다른 스레드가 먼저 가져갔다면 태그가 바뀌어 CAS 가 실패하니, 낡은 next 를 읽어도 무방
+            const std::uint32_t next = _next[index].load(std::memory_order_relaxed);
+            if (_free_head.compare_exchange_weak(head, next_head(head, next), std::memory_order_acquire,
+                                                 std::memory_order_acquire))
+                return index;
+        }
+    }
+
+    static auto next_head(std::uint64_t head, std::uint32_t index) -> std::uint64_t
+    {
+        return (((head >> 32) + 1) << 32) | index;
+    }
+
+private:
+    const std::uint32_t _capacity;
+    const std::unique_ptr<Slot[]> _slots;
+
+    // next index on the free stack or on the retired stack; a slot is never on both
+    const std::unique_ptr<std::atomic<std::uint32_t>[]> _next;
+
+    std::atomic<std::uint64_t> _free_head = NIL;
+
+    std::atomic<std::uint32_t> _retired_head = NIL;
+    std::atomic<std::uint32_t> _retired_count = 0;
+    std::atomic_flag _reclaiming;
+};
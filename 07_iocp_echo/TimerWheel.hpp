@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/// Hashed timer wheel of one thread: `slots` buckets of `tick` each, a timer in the bucket of its deadline tick
+/// (modulo the wheel), and `advance()` visits only the buckets whose tick has passed.
+///
+/// Timers aren't moved on every activity: the owner just stamps the time of it (O(1), no lock), and when a timer
+/// expires, `on_expired` looks at that stamp and either acts, or hands back the real deadline to wait for.
+/// So a busy session costs one re-schedule per timeout period, not one per completion.
+///
+/// Keys are opaque; make them unique per session lifetime (e.g. tagged with a generation), as a timer may outlive
+/// its session and expire on a recycled one.
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Key = std::uint64_t;
+
+    static constexpr auto DEFAULT_TICK = std::chrono::milliseconds(100);
+    static constexpr std::size_t DEFAULT_SLOTS = 1024; // 102.4s per turn
+
+private:
+    struct Timer
+    {
+        Key key;
+        std::uint64_t tick; // absolute; a later turn of the wheel stays in the bucket until then
+    };
+
+public:
+    /// @param slots power of 2
+    explicit TimerWheel(Clock::time_point now, Clock::duration tick = DEFAULT_TICK,
+                        std::size_t slots = DEFAULT_SLOTS)
+        : _origin(now), _tick(tick), _mask(slots - 1), _slots(slots)
+    {
+        assert(slots > 0 && 0 == (slots & _mask));
+    }
+
+public:
+    auto tick() const -> Clock::duration
+    {
+        return _tick;
+    }
+
+    auto size() const -> std::size_t
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return 0 == _size;
+    }
+
+    /// Expires `key` on the first `advance()` at or past `deadline` (rounded up to a tick).
+    void schedule(Key key, Clock::time_point deadline)
+    {
+        const auto since = deadline - _origin;
+        std::uint64_t tick = (since <= Clock::duration::zero()) ? 0 : (since + _tick - Clock::duration(1)) / _tick;
+
+        // 이미 지난 칸에 넣으면 한 바퀴 뒤에야 보게 되니, 다음 틱으로
+        tick = std::max(tick, _current + 1);
+
+        _slots[tick & _mask].push_back({key, tick});
+        ++_size;
+    }
+
+    /// Expires the timers due by `now`, calling `on_expired(key) -> std::optional<Clock::time_point>` on each:
+    /// a deadline re-schedules the key, `std::nullopt` drops it.
+    /// @return number of timers expired
+    template <typename OnExpired>
+    auto advance(Clock::time_point now, OnExpired&& on_expired) -> std::size_t
+    {
+        if (now < _origin)
+            return 0;
+
+        std::size_t expired = 0;
+        const auto target = static_cast<std::uint64_t>((now - _origin) / _tick);
+        while (_current < target && !empty())
+        {
+            ++_current;
+
+            // 콜백이 같은 칸에 다시 넣을 수 있으니 떼어내서 순회
+            std::vector<Timer>& slot = _slots[_current & _mask];
+            _expiring.swap(slot);
+            for (const Timer& timer : _expiring)
+            {
+                if (timer.tick > _current)
+                {
+                    slot.push_back(timer);
+                    continue;
+                }
+
+                --_size;
+                ++expired;
+                if (const std::optional<Clock::time_point> deadline = on_expired(timer.key))
+                    schedule(timer.key, *deadline);
+            }
+            _expiring.clear();
+        }
+
+        // 비어서 건너뛴 틱들
+        _current = std::max(_current, target);
+        return expired;
+    }
+
+    /// How long to wait for I/O before the next tick is due, or `std::nullopt` without any timer.
+    auto until_next_tick(Clock::time_point now) const -> std::optional<Clock::duration>
+    {
+        if (empty())
+            return std::nullopt;
+
+        const Clock::time_point next = _origin + static_cast<Clock::rep>(_current + 1) * _tick;
+        return std::max(next - now, Clock::duration::zero());
+    }
+
+private:
+    const Clock::time_point _origin;
+    const Clock::duration _tick;
+    const std::size_t _mask;
+
+    std::vector<std::vector<Timer>> _slots;
+    std::vector<Timer> _expiring;
+    std::uint64_t _current = 0; // last tick visited
+    std::size_t _size = 0;
+};
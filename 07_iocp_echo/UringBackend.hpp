@@ -0,0 +1,719 @@
+#pragma once
+
+#include "IoUring.hpp"
+#include "SessionBuffer.hpp"
+#include "TimerWheel.hpp"
+#include "linux_common.hpp"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/// Completion-based event loop of one worker thread on io_uring, mirroring the IOCP server model.
+///
+/// - Each session posts one multishot receive, which the kernel fills from a per-worker provided buffer ring;
+///   the received bytes move into the session ring buffer, and those buffers go right back to the kernel.
+/// - Each session ring buffer is registered as a fixed buffer at its slot index,
+///   so sends (`IORING_OP_WRITE_FIXED`) skip pinning the pages on every call.
+/// - Everything posted while handling a batch of completions goes to the kernel in one `io_uring_enter()`,
+///   which also reaps the next batch.
+/// - Sessions are handed over by the acceptor thread, or accepted by the worker itself
+///   with a multishot accept on its own listener.
+/// - A session silent for too long, or whose send doesn't complete for too long, is closed by the worker's
+///   timer wheel, checked whenever the wait for completions returns (or times out at its next tick).
+class UringWorker
+{
+private:
+    using Clock = TimerWheel::Clock;
+
+    static constexpr unsigned SQ_ENTRIES = 1024;
+
+    /// Sessions per worker, which is also the size of the fixed buffer table.
+    static constexpr std::uint32_t MAX_SESSIONS = 4096;
+
+    static constexpr std::uint16_t RECV_BUF_COUNT = 1024; // power of 2
+    static constexpr std::uint32_t RECV_BUF_SIZE = RING_BUF_SIZE;
+    static constexpr std::uint16_t RECV_BUF_GROUP = 0;
+
+    enum class Op : std::uint8_t
+    {
+        INBOX,
+        ACCEPT,
+        RECV,
+        SEND,
+        CANCEL, // of a session's multishot receive
+    };
+
+    /// Received bytes, not yet moved into the session ring buffer as it was full.
+    struct Parked
+    {
+        std::uint16_t bid;
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    struct Session
+    {
+        UniqueFd sock;
+        SessionBuffer buf;
+        std::deque<Parked> parked;
+        std::uint32_t serial; // tells this session from a later one in the same slot, in its timer key
+
+        bool receiving = false; // multishot receive armed
+        bool sending = false;
+        bool starved = false;     // receive ended with `-ENOBUFS`, re-arm once buffers are back
+        bool recv_paused = false; // receive cancelled as the ring buffer is full, re-armed once nothing is parked
+        bool closing = false;
+
+        Clock::time_point last_received;
+        Clock::time_point send_posted; // of the send in flight
+
+        Session(int fd, std::uint32_t serial_, Clock::time_point now)
+            : sock(fd), buf(RING_BUF_SIZE), serial(serial_), last_received(now), send_posted(now)
+        {
+        }
+    };
+
+public:
+    static constexpr unsigned DEFAULT_BATCH = 256;
+
+    /// Registers the buffers here, but submits only from `run()`'s thread.
+    /// @param batch CQEs handled per `io_uring_enter()`; the rest wait for the next one
+    explicit UringWorker(unsigned batch = DEFAULT_BATCH, const SessionTimeouts& timeouts = {})
+        : _ring(SQ_ENTRIES), _batch(batch), _slots(MAX_SESSIONS), _timeouts(timeouts), _now(Clock::now()),
+          _timers(_now)
+    {
+        // 세션 링버퍼들을 위한 빈 고정 버퍼 테이블
+        io_uring_rsrc_register table{};
+        table.nr = MAX_SESSIONS;
+        table.flags = IORING_RSRC_REGISTER_SPARSE;
+        if (const int error = _ring.register_op(IORING_REGISTER_BUFFERS2, &table, sizeof(table)); error < 0)
+            throw std::system_error(-error, std::system_category(), "IORING_REGISTER_BUFFERS2");
+
+        setup_recv_buffers();
+
+        _free_slots.reserve(MAX_SESSIONS);
+        for (std::uint32_t i = MAX_SESSIONS; i > 0; --i)
+            _free_slots.push_back(i - 1);
+    }
+
+    ~UringWorker()
+    {
+        if (_buf_ring)
+            munmap(_buf_ring, buf_ring_size());
+    }
+
+    UringWorker(const UringWorker&) = delete;
+    UringWorker& operator=(const UringWorker&) = delete;
+
+public:
+    /// Throws if this kernel lacks what `UringWorker` needs, so that the caller can fall back to epoll.
+    static void require_support()
+    {
+        // 멀티샷 수신은 6.0 부터 (opcode 로는 알 수 없음)
+        utsname name;
+        unsigned major = 0, minor = 0;
+        if (uname(&name) || std::sscanf(name.release, "%u.%u", &major, &minor) != 2 || major < 6)
+            throw std::runtime_error("multishot receive needs Linux 6.0 or later");
+
+        IoUring ring(8);
+        if (!(ring.features() & IORING_FEAT_NODROP) || !(ring.features() & IORING_FEAT_EXT_ARG))
+            throw std::runtime_error("io_uring lacks IORING_FEAT_NODROP or IORING_FEAT_EXT_ARG");
+        for (const std::uint8_t op :
+             {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_WRITE_FIXED, IORING_OP_READ, IORING_OP_ASYNC_CANCEL})
+        {
+            if (!ring.supports(op))
+                throw std::runtime_error("io_uring lacks a required opcode");
+        }
+    }
+
+    /// Accepts on `listener` too (a `SO_REUSEPORT` one of its own), from `run()`.
+    /// Before `run()`.
+    void accept_on(int listener)
+    {
+        _listener = listener;
+    }
+
+    /// Any thread.
+    void add_session(int fd)
+    {
+        _inbox.push(fd);
+    }
+
+    /// Any thread.
+    void stop()
+    {
+        _stopping.store(true);
+        _inbox.wake();
+    }
+
+    auto stats() const -> const WorkerStats&
+    {
+        return _stats;
+    }
+
+    void run()
+    {
+        _ring.enable();
+        arm_inbox();
+        if (_listener >= 0)
+            arm_accept();
+
+        while (!_stopped || _live_sessions > 0)
+        {
+            // 지난 배치에서 쌓인 SQE 를 제출하면서 다음 완료를 기다림 (남은 CQE 가 있으면 바로 리턴)
+            const Clock::time_point now = Clock::now();
+            std::optional<Clock::duration> wait = _timers.until_next_tick(now);
+            if (_accept_paused_until)
+                wait = std::min(wait.value_or(Clock::duration::max()),
+                                std::max(*_accept_paused_until - now, Clock::duration::zero()));
+            _ring.submit_and_wait(1, wait ? std::chrono::nanoseconds(*wait).count() : -1);
+            WorkerStats::add(_stats.syscalls);
+
+            // 배치마다 한 번만 시계를 읽고, 세션에는 그 시각을 찍음
+            _now = Clock::now();
+
+            const unsigned count = _ring.for_each_cqe([this](const io_uring_cqe& cqe) { on_completion(cqe); }, _batch);
+            WorkerStats::add(_stats.waits);
+            WorkerStats::add(_stats.completions, count);
+            rearm_starved();
+
+            _timers.advance(_now, [this](TimerWheel::Key key) { return on_timer(key); });
+
+            // 다시 건 accept 는 다음 `io_uring_enter()` 에서 제출됨
+            if (_accept_paused_until && _now >= *_accept_paused_until)
+            {
+                _accept_paused_until.reset();
+                if (!_stopped)
+                    arm_accept();
+            }
+        }
+    }
+
+private:
+    static auto user_data(Op op, std::uint32_t index) -> std::uint64_t
+    {
+        return (static_cast<std::uint64_t>(index) << 8) | static_cast<std::uint64_t>(op);
+    }
+
+    void on_completion(const io_uring_cqe& cqe)
+    {
+        const auto op = static_cast<Op>(cqe.user_data & 0xFF);
+        const auto index = static_cast<std::uint32_t>(cqe.user_data >> 8);
+
+        switch (op)
+        {
+        case Op::INBOX:
+            on_inbox();
+            break;
+        case Op::ACCEPT:
+            on_accept(cqe);
+            break;
+        case Op::RECV:
+            on_recv(index, cqe);
+            break;
+        case Op::SEND:
+            on_send(index, cqe.res);
+            break;
+        case Op::CANCEL:
+            break;
+        }
+    }
+
+    void arm_inbox()
+    {
+        io_uring_sqe* const sqe = _ring.get_sqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = _inbox.event_fd();
+        sqe->addr = reinterpret_cast<std::uint64_t>(&_inbox_counter);
+        sqe->len = sizeof(_inbox_counter);
+        sqe->user_data = user_data(Op::INBOX, 0);
+    }
+
+    void on_inbox()
+    {
+        if (_stopping.load())
+        {
+            // 다시 걸지 않음: 남은 세션들이 정리되면 `run()` 종료
+            _stopped = true;
+            for (std::uint32_t i = 0; i < MAX_SESSIONS; ++i)
+            {
+                if (_slots[i])
+                {
+                    close(i);
+                    release_if_done(i);
+                }
+            }
+            return;
+        }
+
+        _inbox.take(_accepted);
+        for (const int fd : _accepted)
+            open(fd);
+        arm_inbox();
+    }
+
+    void arm_accept()
+    {
+        io_uring_sqe* const sqe = _ring.get_sqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = _listener;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = user_data(Op::ACCEPT, 0);
+    }
+
+    void on_accept(const io_uring_cqe& cqe)
+    {
+        if (cqe.res >= 0)
+        {
+            // 멈추는 중이면 받자마자 닫음: 남은 세션이 0 이 되어야 `run()` 이 끝남
+            if (_stopped)
+            {
+                ::close(cqe.res);
+            }
+            else
+            {
+                WorkerStats::add(_stats.syscalls);
+                if (set_no_delay(cqe.res))
+                    open(cqe.res);
+                else
+                    ::close(cqe.res);
+            }
+        }
+        else if (is_out_of_resources(-cqe.res))
+        {
+            // 멀티샷 accept 가 끝났음: 곧장 다시 걸면 같은 에러만 계속 받으니, 세션이 닫히거나 잠시 뒤에
+            WorkerStats::add(_stats.accept_failures);
+            if (!(cqe.flags & IORING_CQE_F_MORE))
+            {
+                _accept_paused_until = _now + ACCEPT_BACKOFF;
+                return;
+            }
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE) && !_stopped)
+            arm_accept();
+    }
+
+    void open(int fd)
+    {
+        if (_free_slots.empty())
+        {
+            ::close(fd);
+            return;
+        }
+
+        const std::uint32_t index = _free_slots.back();
+        _free_slots.pop_back();
+        const std::uint32_t serial = _next_serial++;
+        auto& session = *(_slots[index] = std::make_unique<Session>(fd, serial, _now));
+        ++_live_sessions;
+        WorkerStats::add(_stats.sessions);
+        _timers.schedule(timer_key(index, serial), next_check());
+
+        // 링버퍼를 슬롯 번호에 고정 버퍼로 등록
+        const std::span<std::byte> storage = storage_span(session.buf);
+        register_buffer(index, {storage.data(), storage.size()});
+
+        arm_recv(index);
+    }
+
+    void register_buffer(std::uint32_t index, iovec iov)
+    {
+        std::uint64_t tag = 0;
+        io_uring_rsrc_update2 update{};
+        update.offset = index;
+        update.data = reinterpret_cast<std::uint64_t>(&iov);
+        update.tags = reinterpret_cast<std::uint64_t>(&tag);
+        update.nr = 1;
+        WorkerStats::add(_stats.syscalls);
+        if (const int error = _ring.register_op(IORING_REGISTER_BUFFERS_UPDATE, &update, sizeof(update)); error < 0)
+            throw std::system_error(-error, std::system_category(), "IORING_REGISTER_BUFFERS_UPDATE");
+    }
+
+    void arm_recv(std::uint32_t index)
+    {
+        Session& session = *_slots[index];
+
+        io_uring_sqe* const sqe = _ring.get_sqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = session.sock.get();
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = RECV_BUF_GROUP;
+        sqe->user_data = user_data(Op::RECV, index);
+
+        session.receiving = true;
+        session.starved = false;
+    }
+
+    void on_recv(std::uint32_t index, const io_uring_cqe& cqe)
+    {
+        Session& session = *_slots[index];
+        const bool more = cqe.flags & IORING_CQE_F_MORE;
+        if (!more)
+            session.receiving = false;
+
+        if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER))
+        {
+            const auto bid = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            ++_recv_bufs_held;
+            WorkerStats::add(_stats.echoes);
+            session.last_received = _now;
+            if (session.closing)
+            {
+                recycle(bid);
+            }
+            else
+            {
+                session.parked.push_back({bid, 0, static_cast<std::uint32_t>(cqe.res)});
+                unpark(session);
+                send(index);
+
+                // 링버퍼가 찼으면 수신을 멈춤: 안 그러면 읽지 않는 상대가 워커의 수신 버퍼를 다 가져가고,
+                // TCP 흐름 제어도 안 걸림
+                if (!session.parked.empty() && more && !session.recv_paused)
+                    cancel_recv(index);
+            }
+        }
+
+        if (!more && !session.closing)
+        {
+            // 버퍼가 모자라서 끝난 경우만 살려둠: 송신이 끝나 버퍼가 돌아오면 다시 걸어줌
+            if (-ENOBUFS == cqe.res)
+            {
+                session.starved = true;
+                _starved.push_back(index);
+            }
+            else if (cqe.res > 0 || (-ECANCELED == cqe.res && session.recv_paused))
+                resume_recv(index);
+            else
+                close(index);
+        }
+
+        release_if_done(index);
+    }
+
+    /// Stops the multishot receive until the parked buffers fit in the ring buffer; completes with `-ECANCELED`.
+    void cancel_recv(std::uint32_t index)
+    {
+        io_uring_sqe* const sqe = _ring.get_sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = user_data(Op::RECV, index);
+        sqe->user_data = user_data(Op::CANCEL, index);
+
+        _slots[index]->recv_paused = true;
+    }
+
+    /// Re-arms the receive, once its previous one is over and nothing is left parked.
+    void resume_recv(std::uint32_t index)
+    {
+        Session& session = *_slots[index];
+        if (session.closing || session.receiving)
+            return;
+
+        session.recv_paused = !session.parked.empty();
+        if (!session.recv_paused)
+            arm_recv(index);
+    }
+
+    /// Moves parked receive buffers into the ring buffer, as much as it fits.
+    void unpark(Session& session)
+    {
+        while (!session.parked.empty())
+        {
+            Parked& parked = session.parked.front();
+            const std::uint32_t length =
+                std::min<std::uint32_t>(parked.length, static_cast<std::uint32_t>(session.buf.available_space()));
+            if (0 == length)
+                return;
+
+            session.buf.try_write(recv_buffer(parked.bid) + parked.offset, length);
+            parked.offset += length;
+            parked.length -= length;
+            if (parked.length > 0)
+                return;
+
+            recycle(parked.bid);
+            session.parked.pop_front();
+        }
+    }
+
+    void send(std::uint32_t index)
+    {
+        Session& session = *_slots[index];
+        if (session.sending || session.closing)
+            return;
+
+        // 한 번에 하나만 송신: 두 조각이면 첫 조각을 보내고, 나머지는 완료 후에
+        const IoSegments filled = filled_segments(session.buf);
+        if (filled.empty())
+            return;
+
+        io_uring_sqe* const sqe = _ring.get_sqe();
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->fd = session.sock.get();
+        sqe->addr = reinterpret_cast<std::uint64_t>(filled.parts[0].data());
+        sqe->len = static_cast<std::uint32_t>(filled.parts[0].size());
+        sqe->buf_index = static_cast<std::uint16_t>(index);
+        sqe->user_data = user_data(Op::SEND, index);
+
+        session.sending = true;
+        session.send_posted = _now;
+    }
+
+    void on_send(std::uint32_t index, int res)
+    {
+        Session& session = *_slots[index];
+        session.sending = false;
+
+        if (res < 0)
+        {
+            close(index);
+        }
+        else if (!session.closing)
+        {
+            session.buf.move_read_pos(static_cast<std::size_t>(res));
+            WorkerStats::add(_stats.bytes, static_cast<std::uint64_t>(res));
+
+            unpark(session);
+            send(index);
+            if (session.recv_paused)
+                resume_recv(index);
+        }
+
+        release_if_done(index);
+    }
+
+    /// Stops the session; it's released by `release_if_done()` once its pending operations complete.
+    void close(std::uint32_t index)
+    {
+        Session& session = *_slots[index];
+        if (session.closing)
+            return;
+
+        session.closing = true;
+        for (const Parked& parked : session.parked)
+            recycle(parked.bid);
+        session.parked.clear();
+
+        // 걸려있는 멀티샷 수신과 송신을 끝내게 함
+        shutdown(session.sock.get(), SHUT_RDWR);
+        WorkerStats::add(_stats.syscalls);
+    }
+
+    void release_if_done(std::uint32_t index)
+    {
+        const Session& session = *_slots[index];
+        if (!session.closing || session.receiving || session.sending)
+            return;
+
+        register_buffer(index, {nullptr, 0});
+        _slots[index].reset();
+        _free_slots.push_back(index);
+        --_live_sessions;
+
+        // fd 가 하나 났으니 accept 재개
+        if (_accept_paused_until)
+            _accept_paused_until = _now;
+    }
+
+    static auto timer_key(std::uint32_t index, std::uint32_t serial) -> TimerWheel::Key
+    {
+        return (static_cast<TimerWheel::Key>(serial) << 32) | index;
+    }
+
+    /// Closes the session of `key` if it's been idle or stalled for too long, or tells when to check again.
+    auto on_timer(TimerWheel::Key key) -> std::optional<Clock::time_point>
+    {
+        const auto index = static_cast<std::uint32_t>(key);
+        Session* const session = _slots[index].get();
+        if (!session || session->serial != static_cast<std::uint32_t>(key >> 32) || session->closing)
+            return std::nullopt;
+
+        // 송신이 걸려있으면 상대가 안 읽는 중인지를, 아니면 상대가 조용한지를 봄
+        const Clock::time_point deadline = session->sending ? session->send_posted + _timeouts.write_stall
+                                                            : session->last_received + _timeouts.idle;
+        if (_now < deadline)
+            return std::min(deadline, next_check());
+
+        WorkerStats::add(session->sending ? _stats.stall_timeouts : _stats.idle_timeouts);
+        close(index);
+        release_if_done(index);
+        return std::nullopt;
+    }
+
+    /// Latest time to look at a session again, as it may start stalling anytime: a stall is noticed
+    /// within twice its timeout.
+    auto next_check() const -> Clock::time_point
+    {
+        return _now + std::min(_timeouts.idle, _timeouts.write_stall);
+    }
+
+    void rearm_starved()
+    {
+        while (!_starved.empty() && _recv_bufs_held < RECV_BUF_COUNT)
+        {
+            const std::uint32_t index = _starved.back();
+            _starved.pop_back();
+
+            Session* const session = _slots[index].get();
+            if (session && session->starved)
+            {
+                session->starved = false;
+                resume_recv(index);
+            }
+        }
+    }
+
+private: // Provided receive buffers
+    static auto buf_ring_size() -> std::size_t
+    {
+        return RECV_BUF_COUNT * sizeof(io_uring_buf);
+    }
+
+    void setup_recv_buffers()
+    {
+        _buf_ring = static_cast<io_uring_buf_ring*>(
+            mmap(nullptr, buf_ring_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (MAP_FAILED == _buf_ring)
+        {
+            _buf_ring = nullptr;
+            throw_errno("mmap buffer ring");
+        }
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<std::uint64_t>(_buf_ring);
+        reg.ring_entries = RECV_BUF_COUNT;
+        reg.bgid = RECV_BUF_GROUP;
+        if (const int error = _ring.register_op(IORING_REGISTER_PBUF_RING, &reg, 1); error < 0)
+            throw std::system_error(-error, std::system_category(), "IORING_REGISTER_PBUF_RING");
+
+        _recv_bufs = std::make_unique<std::byte[]>(static_cast<std::size_t>(RECV_BUF_COUNT) * RECV_BUF_SIZE);
+        for (std::uint16_t bid = 0; bid < RECV_BUF_COUNT; ++bid)
+            provide(bid);
+    }
+
+    auto recv_buffer(std::uint16_t bid) -> std::byte*
+    {
+        return _recv_bufs.get() + static_cast<std::size_t>(bid) * RECV_BUF_SIZE;
+    }
+
+    /// Hands the receive buffer `bid` back to the kernel.
+    void recycle(std::uint16_t bid)
+    {
+        provide(bid);
+        --_recv_bufs_held;
+    }
+
+    void provide(std::uint16_t bid)
+    {
+        // C++ 에서는 `io_uring_buf_ring::bufs` 가 8 바이트 밀려 선언되니 (빈 구조체의 크기가 1), 직접 인덱싱
+        io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(_buf_ring)[_buf_tail & (RECV_BUF_COUNT - 1)];
+        buf.addr = reinterpret_cast<std::uint64_t>(recv_buffer(bid));
+        buf.len = RECV_BUF_SIZE;
+        buf.bid = bid;
+        std::atomic_ref(_buf_ring->tail).store(++_buf_tail, std::memory_order_release);
+    }
+
+private:
+    IoUring _ring;
+    const unsigned _batch;
+    int _listener = -1;
+    std::optional<Clock::time_point> _accept_paused_until; // out of fds or memory, until a session closes
+    SessionInbox _inbox;
+    std::uint64_t _inbox_counter = 0;
+    std::vector<int> _accepted;
+
+    std::vector<std::unique_ptr<Session>> _slots;
+    std::vector<std::uint32_t> _free_slots;
+    std::uint32_t _live_sessions = 0;
+    std::uint32_t _next_serial = 0;
+    std::vector<std::uint32_t> _starved;
+
+    io_uring_buf_ring* _buf_ring = nullptr;
+    std::uint16_t _buf_tail = 0;
+    std::unique_ptr<std::byte[]> _recv_bufs;
+    unsigned _recv_bufs_held = 0; // delivered to sessions, not yet recycled
+
+    const SessionTimeouts _timeouts;
+    Clock::time_point _now; // as of the last `io_uring_enter()`
+    TimerWheel _timers;
+
+    std::atomic<bool> _stopping = false;
+    bool _stopped = false;
+    WorkerStats _stats;
+};
+
+/// Accepts on the main thread with one multishot accept, instead of `poll()` + `accept4()` per connection.
+///
+/// Out of fds or memory, the multishot accept ends; it's re-armed only after `ACCEPT_BACKOFF`.
+class UringAcceptor
+{
+public:
+    explicit UringAcceptor(int listener) : _listener(listener), _ring(64)
+    {
+        _ring.enable();
+        arm();
+    }
+
+public:
+    /// Waits up to `timeout_ms` for new connections, and appends them to `socks`.
+    void accept(std::vector<int>& socks, int timeout_ms)
+    {
+        _ring.submit_and_wait(1, static_cast<std::int64_t>(timeout_ms) * 1'000'000);
+        bool back_off = false;
+        _ring.for_each_cqe([&](const io_uring_cqe& cqe) {
+            if (cqe.res >= 0)
+            {
+                socks.push_back(cqe.res);
+            }
+            else if (is_out_of_resources(-cqe.res))
+            {
+                std::cout << std::format("accept: {}, backing off\n", std::strerror(-cqe.res));
+                back_off = true;
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE))
+                arm();
+        });
+
+        // 다시 건 accept 는 다음 `accept()` 에서야 제출됨
+        if (back_off)
+            std::this_thread::sleep_for(ACCEPT_BACKOFF);
+    }
+
+private:
+    void arm()
+    {
+        io_uring_sqe* const sqe = _ring.get_sqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = _listener;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+    }
+
+private:
+    const int _listener;
+    IoUring _ring;
+};
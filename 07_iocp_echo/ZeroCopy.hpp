@@ -0,0 +1,150 @@
+#pragma once
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+/// `MSG_ZEROCOPY` sends of one socket, whose bytes the kernel keeps reading from the buffer until it's done
+/// with them (their segments ACKed), and tells so on the socket's error queue, as `EPOLLERR`.
+///
+/// Each zero-copy send gets the next number of a per-socket counter, and a notification completes a range of them.
+/// So the sent bytes are held here in send order, and released from the front of the buffer only once every
+/// send before them is complete; the next send starts after the ones in flight.
+///
+/// Zero-copy pays off only for large sends: pinning the pages and taking the notification costs more than copying
+/// a few KiB. And if the route can't do it (loopback, or a NIC without scatter/gather), the kernel copies anyway,
+/// and says so with `SO_EE_CODE_ZEROCOPY_COPIED`: that costs more than a plain copy, so stop when `!worthwhile()`.
+class ZeroCopySends
+{
+private:
+    struct Send
+    {
+        std::uint32_t id; // kernel's counter, zero-copy only
+        std::size_t length;
+        bool done;
+    };
+
+public:
+    struct Reaped
+    {
+        std::size_t released = 0;    // bytes to release from the front of the buffer
+        std::uint64_t completed = 0; // zero-copy sends
+        std::uint64_t copied = 0;    // ... that the kernel copied after all
+        std::uint64_t syscalls = 0;
+    };
+
+public:
+    /// Opts `fd` in to `MSG_ZEROCOPY`.
+    /// @return `false` if the kernel or the socket type doesn't support it
+    static bool enable(int fd)
+    {
+        const int enable = 1;
+        return 0 == setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable));
+    }
+
+public:
+    /// Bytes sent but not released yet, on the front of the buffer.
+    auto in_flight() const -> std::size_t
+    {
+        return _in_flight;
+    }
+
+    /// Any zero-copy send the kernel may still read from.
+    bool pending() const
+    {
+        return !_sends.empty();
+    }
+
+    /// The kernel hasn't copied any of the zero-copy sends so far.
+    bool worthwhile() const
+    {
+        return !_copied;
+    }
+
+    /// Records a send of `length` bytes, right after the ones in flight.
+    /// @return bytes to release from the front of the buffer right away
+    auto sent(std::size_t length, bool zerocopy) -> std::size_t
+    {
+        // 앞에 걸린 zero-copy 가 없는 복사 송신은 바로 해제
+        if (!zerocopy && _sends.empty())
+            return length;
+
+        _sends.push_back({zerocopy ? _next_id++ : 0, length, !zerocopy});
+        _in_flight += length;
+        return 0;
+    }
+
+    /// Reads the completion notifications off the error queue of `fd`, until it's empty.
+    /// @return `std::nullopt` if there's a real error on it instead
+    auto reap(int fd) -> std::optional<Reaped>
+    {
+        Reaped reaped;
+        for (;;)
+        {
+            char control[CMSG_SPACE(sizeof(sock_extended_err)) + CMSG_SPACE(sizeof(sockaddr_in6))];
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            const ssize_t result = recvmsg(fd, &msg, MSG_ERRQUEUE);
+            ++reaped.syscalls;
+            if (result < 0)
+            {
+                if (EAGAIN != errno)
+                    return std::nullopt;
+                break;
+            }
+
+            const cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
+            if (!cmsg || !((SOL_IP == cmsg->cmsg_level && IP_RECVERR == cmsg->cmsg_type) ||
+                           (SOL_IPV6 == cmsg->cmsg_level && IPV6_RECVERR == cmsg->cmsg_type)))
+                return std::nullopt;
+
+            const auto* const err = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+            if (SO_EE_ORIGIN_ZEROCOPY != err->ee_origin || 0 != err->ee_errno)
+                return std::nullopt;
+
+            // [ee_info, ee_data] 범위의 송신이 끝남
+            const std::uint32_t first = err->ee_info;
+            const std::uint32_t count = err->ee_data - first + 1;
+            complete(first, count);
+            reaped.completed += count;
+            if (SO_EE_CODE_ZEROCOPY_COPIED == err->ee_code)
+            {
+                reaped.copied += count;
+                _copied = true;
+            }
+        }
+
+        while (!_sends.empty() && _sends.front().done)
+        {
+            reaped.released += _sends.front().length;
+            _in_flight -= _sends.front().length;
+            _sends.pop_front();
+        }
+        return reaped;
+    }
+
+private:
+    void complete(std::uint32_t first, std::uint32_t count)
+    {
+        // 알림은 보통 순서대로 오지만, 보장되진 않음 (카운터는 32비트로 돌아감)
+        for (Send& send : _sends)
+        {
+            if (!send.done && static_cast<std::uint32_t>(send.id - first) < count)
+                send.done = true;
+        }
+    }
+
+private:
+    std::deque<Send> _sends;
+    std::size_t _in_flight = 0;
+    std::uint32_t _next_id = 0;
+    bool _copied = false;
+};
@@ -0,0 +1,203 @@
+#include "BufferPool.hpp"
+#include "SessionBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::uint32_t DEFAULT_SESSIONS = 100'000;
+static constexpr int DEFAULT_THREADS = 4;
+
+// 매 틱마다 세션의 1% 가 메시지 하나를 에코
+static constexpr int TICKS = 50;
+static constexpr int ACTIVE_PER_MILLE = 10;
+
+static constexpr std::size_t MIN_MESSAGE_SIZE = 16;
+static constexpr std::size_t MAX_MESSAGE_SIZE = 16 * 1024;
+
+// the fixed ring each session used to allocate at accept time
+static constexpr std::size_t FIXED_SIZE = 2048;
+
+static constexpr double MIB = 1024.0 * 1024.0;
+
+enum class BufferMode
+{
+    FIXED,     // attached when the session starts, kept until it ends
+    ON_DEMAND, // attached per message, sized for it, detached once echoed
+};
+
+struct BenchResult
+{
+    double seconds;
+    std::uint64_t messages;
+    std::size_t peak_held;    // sum of the threads' peaks
+    std::size_t held_at_rest; // once every message is echoed
+    bool verified;
+};
+
+/// Receives `message` into `buf` and sends it back out, in as many rounds as its room takes,
+/// checking that what comes out is what went in.
+bool echo(DuplexSessionBuffer& buf, std::span<const std::byte> message)
+{
+    for (std::size_t pos = 0; pos < message.size();)
+    {
+        const IoSegments free = buf.free_segments();
+        std::size_t received = 0;
+        for (std::size_t i = 0; i < free.count && pos + received < message.size(); ++i)
+        {
+            const std::size_t length = std::min(free.parts[i].size(), message.size() - pos - received);
+            std::memcpy(free.parts[i].data(), message.data() + pos + received, length);
+            received += length;
+        }
+        buf.commit_received(received);
+
+        const IoSegments filled = buf.filled_segments();
+        std::size_t sent = 0;
+        for (std::size_t i = 0; i < filled.count; ++i)
+        {
+            if (0 != std::memcmp(filled.parts[i].data(), message.data() + pos + sent, filled.parts[i].size()))
+                return false;
+            sent += filled.parts[i].size();
+        }
+        buf.commit_sent(sent);
+
+        if (0 == received || sent != received)
+            return false;
+        pos += sent;
+    }
+    return true;
+}
+
+/// Every thread owns a slice of the sessions, and on each tick echoes a random-sized message on a few of them.
+template <BufferMode Mode>
+auto bench(std::uint32_t sessions, int threads, std::span<const std::byte> pattern) -> BenchResult
+{
+    std::vector<DuplexSessionBuffer> bufs(sessions);
+    std::atomic<std::size_t> peak_held = 0;
+    std::atomic<std::uint64_t> messages = 0;
+    std::atomic<bool> verified = true;
+
+    const auto started = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                const std::uint32_t first = static_cast<std::uint32_t>(std::uint64_t(sessions) * t / threads);
+                const std::uint32_t last = static_cast<std::uint32_t>(std::uint64_t(sessions) * (t + 1) / threads);
+
+                std::size_t held = 0, peak = 0;
+                if constexpr (Mode == BufferMode::FIXED)
+                {
+                    for (std::uint32_t i = first; i < last; ++i)
+                    {
+                        bufs[i].attach(BufferPool::size_class_of(FIXED_SIZE));
+                        held += bufs[i].capacity();
+                    }
+                    peak = held;
+                }
+
+                std::mt19937 rng(t);
+                std::uniform_int_distribution<std::uint32_t> pick(first, last - 1);
+                std::uniform_int_distribution<std::size_t> size(MIN_MESSAGE_SIZE, MAX_MESSAGE_SIZE);
+                const std::uint32_t active = std::max<std::uint32_t>(1, (last - first) * ACTIVE_PER_MILLE / 1000);
+
+                std::uint64_t count = 0;
+                for (int tick = 0; tick < TICKS; ++tick)
+                {
+                    for (std::uint32_t k = 0; k < active; ++k, ++count)
+                    {
+                        DuplexSessionBuffer& buf = bufs[pick(rng)];
+                        const std::size_t message_size = size(rng);
+                        const auto message = pattern.subspan(count % 251, message_size);
+
+                        if constexpr (Mode == BufferMode::ON_DEMAND)
+                        {
+                            buf.attach(BufferPool::size_class_of(message_size));
+                            held += buf.capacity();
+                            peak = std::max(peak, held);
+                        }
+
+                        if (!echo(buf, message))
+                            verified = false;
+
+                        if constexpr (Mode == BufferMode::ON_DEMAND)
+                        {
+                            held -= buf.capacity();
+                            buf.detach();
+                        }
+                    }
+                }
+
+                peak_held += peak;
+                messages += count;
+            });
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    std::size_t held_at_rest = 0;
+    for (const DuplexSessionBuffer& buf : bufs)
+        held_at_rest += buf.capacity();
+
+    return {elapsed.count(), messages.load(), peak_held.load(), held_at_rest, verified.load()};
+}
+
+/// Usage: 07_buffer_pool_bench [sessions] [threads]
+int main(int argc, char** argv)
+{
+    const long sessions = (argc >= 2) ? std::atol(argv[1]) : DEFAULT_SESSIONS;
+    const int threads = (argc >= 3) ? std::atoi(argv[2]) : DEFAULT_THREADS;
+    if (argc > 3 || sessions <= 0 || threads <= 0 || sessions < threads)
+    {
+        std::cout << "Usage: 07_buffer_pool_bench [sessions] [threads]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::byte> pattern(251 + MAX_MESSAGE_SIZE);
+    for (std::size_t i = 0; i < pattern.size(); ++i)
+        pattern[i] = static_cast<std::byte>(i % 251);
+
+    std::cout << std::format("{} idle sessions, {} threads; {} ticks, each echoing a {}~{} byte message "
+                             "on {}% of the sessions\n",
+                             sessions, threads, TICKS, MIN_MESSAGE_SIZE, MAX_MESSAGE_SIZE, ACTIVE_PER_MILLE / 10.0);
+    std::cout << std::format("{:>22} | {:>12} | {:>15} | {:>18}\n", "buffers", "msgs/s", "peak held (MiB)",
+                             "held at rest (MiB)");
+
+    bool all_is_well = true;
+
+    auto report = [&](const char* name, const BenchResult& result) {
+        std::cout << std::format("{:>22} | {:>12.0f} | {:>15.1f} | {:>18.1f}\n", name,
+                                 result.messages / result.seconds, result.peak_held / MIB,
+                                 result.held_at_rest / MIB);
+        all_is_well = all_is_well && result.verified;
+    };
+
+    const auto count = static_cast<std::uint32_t>(sessions);
+    const BenchResult on_demand = bench<BufferMode::ON_DEMAND>(count, threads, pattern);
+    report("pooled, on demand", on_demand);
+    const BenchResult fixed = bench<BufferMode::FIXED>(count, threads, pattern);
+    report("fixed 2 KiB per session", fixed);
+
+    std::cout << std::format("pool reserved {:.1f} MiB from the OS in total\n",
+                             BufferPool::instance().reserved_bytes() / MIB);
+
+    // 쉬는 세션은 버퍼를 하나도 들고 있지 않아야 함
+    all_is_well = all_is_well && 0 == on_demand.held_at_rest && on_demand.peak_held < fixed.held_at_rest;
+
+    if (!all_is_well)
+        std::cout << "verification failed!" << std::endl;
+    return !all_is_well;
+}
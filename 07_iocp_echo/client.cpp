@@ -3,19 +3,355 @@
 #include <DirtySocks/System.hpp>
 #include <DirtySocks/TcpSocket.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <format>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 static constexpr std::uint16_t PORT = 32983;
 static constexpr const char* PORT_STR = "32983";
 
+using Clock = std::chrono::steady_clock;
+
+struct PipelineOptions
+{
+    unsigned depth;           // messages sent but not echoed yet
+    std::size_t message_size;
+    double seconds;
+};
+
+/// Keeps `depth` messages outstanding for `seconds`: one thread sends, the other receives the echoes.
+void run_pipeline(ds::TcpSocket& sock, const PipelineOptions& options)
+{
+    const std::string message(options.message_size, 'x');
+
+    std::atomic<std::uint64_t> sent_messages = 0;
+    std::atomic<std::uint64_t> echoed_messages = 0;
+    std::atomic<std::uint64_t> last_message = UINT64_MAX; // set by the sender when it's done
+
+    const auto started = Clock::now();
+
+    std::jthread receiver([&]() {
+        std::error_code ec;
+        std::vector<char> buf(64 * 1024);
+        std::size_t partial = 0;
+
+        while (echoed_messages.load() != last_message.load())
+        {
+            std::size_t received;
+            sock.receive(buf.data(), buf.size(), received, ec);
+            check_ec(ec);
+            if (0 == received)
+            {
+                std::cout << "Server closed the connection" << std::endl;
+                std::exit(1);
+            }
+
+            partial += received;
+            echoed_messages.fetch_add(partial / options.message_size);
+            partial %= options.message_size;
+            echoed_messages.notify_one();
+        }
+    });
+
+    std::error_code ec;
+    for (bool last = false; !last;)
+    {
+        // 그만 보낼 때, 마지막 메시지 번호를 먼저 알리고 보내야 수신 스레드가 그 에코를 기다림
+        last = Clock::now() - started >= std::chrono::duration<double>(options.seconds);
+        if (last)
+            last_message.store(sent_messages.load() + 1);
+
+        for (std::uint64_t echoed = echoed_messages.load(); sent_messages.load() - echoed >= options.depth;
+             echoed = echoed_messages.load())
+            echoed_messages.wait(echoed);
+
+        for (std::size_t pos = 0; pos < message.size();)
+        {
+            std::size_t sent;
+            sock.send(message.data() + pos, message.size() - pos, sent, ec);
+            check_ec(ec);
+            pos += sent;
+        }
+        sent_messages.fetch_add(1);
+    }
+
+    receiver.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    const double messages = static_cast<double>(echoed_messages.load());
+    std::cout << std::format("depth {}, {} bytes: {:.0f} msgs/s, {:.1f} MiB/s\n", options.depth,
+                             options.message_size, messages / elapsed.count(),
+                             messages * options.message_size / elapsed.count() / (1024 * 1024));
+}
+
+struct ChurnOptions
+{
+    unsigned threads;
+    double seconds;
+};
+
+/// Each thread connects, echoes one short message, and disconnects, over and over for `seconds`.
+/// Stresses the server's session setup and teardown, racing its last completions against the disconnect.
+void run_churn(const ds::SocketAddress& addr, const ChurnOptions& options)
+{
+    static constexpr std::string_view MESSAGE = "churn";
+
+    std::atomic<std::uint64_t> connections = 0;
+    std::atomic<std::uint64_t> failures = 0;
+
+    const auto started = Clock::now();
+    const auto deadline = started + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(options.seconds));
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned t = 0; t < options.threads; ++t)
+        {
+            threads.emplace_back([&]() {
+                std::uint64_t ok = 0, failed = 0;
+                while (Clock::now() < deadline)
+                {
+                    std::error_code ec;
+                    ds::TcpSocket sock;
+                    sock.connect(addr, ec);
+
+                    std::size_t sent = 0;
+                    if (!ec)
+                        sock.send(MESSAGE.data(), MESSAGE.size(), sent, ec);
+
+                    char echoed[MESSAGE.size()];
+                    std::size_t pos = 0;
+                    while (!ec && pos < sizeof(echoed))
+                    {
+                        std::size_t received;
+                        sock.receive(echoed + pos, sizeof(echoed) - pos, received, ec);
+                        if (0 == received)
+                            break;
+                        pos += received;
+                    }
+                    sock.close();
+
+                    if (ec || sent != MESSAGE.size() || pos != MESSAGE.size() ||
+                        std::string_view(echoed, pos) != MESSAGE)
+                        ++failed;
+                    else
+                        ++ok;
+                }
+                connections += ok;
+                failures += failed;
+            });
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    std::cout << std::format("{} threads: {:.0f} connections/s, {} failed\n", options.threads,
+                             connections.load() / elapsed.count(), failures.load());
+}
+
+struct SilentOptions
+{
+    unsigned connections;
+    double seconds; // to wait for the server to close them
+};
+
+/// Opens `connections` connections that each echo one message, then go silent: half of them send nothing more
+/// (idle), the other half keep sending but never read the echoes, until the server can't send any more (stalled).
+/// Exits with failure unless the server closes every one of them within `seconds`.
+void run_silent(const ds::SocketAddress& addr, const SilentOptions& options)
+{
+    static constexpr std::string_view MESSAGE = "silent";
+    static constexpr std::size_t FLOOD_CHUNK = 64 * 1024;
+
+#ifndef _WIN32
+    // 서버가 리셋한 소켓에 보내다가 죽지 않고 에러를 받음
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    // how long each connection lasted since it went silent, `0` while it's open
+    std::vector<std::atomic<Clock::rep>> lasted(options.connections);
+    std::atomic<unsigned> closed = 0;
+
+    for (unsigned c = 0; c < options.connections; ++c)
+    {
+        // 서버가 끝내 안 닫으면 막힌 채로 남으니, 기다리지 않고 떼어냄
+        std::thread([&, c]() {
+            std::error_code ec;
+            ds::TcpSocket sock;
+            sock.connect(addr, ec);
+            check_ec(ec);
+
+            std::size_t sent;
+            sock.send(MESSAGE.data(), MESSAGE.size(), sent, ec);
+            check_ec(ec);
+            char echoed[MESSAGE.size()];
+            for (std::size_t pos = 0, received; pos < sizeof(echoed); pos += received)
+            {
+                sock.receive(echoed + pos, sizeof(echoed) - pos, received, ec);
+                check_ec(ec);
+                if (0 == received)
+                {
+                    std::cout << "Server closed the connection before going silent" << std::endl;
+                    std::exit(1);
+                }
+            }
+
+            auto silent_since = Clock::now();
+            if (c % 2)
+            {
+                // 에코를 안 읽으니 결국 양쪽 소켓 버퍼가 차서 막히고, 서버가 끊어야 에러로 풀림
+                const std::string flood(FLOOD_CHUNK, 'x');
+                // 끊기면 에러, 또는 막혀있던 송신이 덜 보낸 채로 리턴
+                for (sent = flood.size(); !ec && sent == flood.size();)
+                {
+                    silent_since = Clock::now();
+                    sock.send(flood.data(), flood.size(), sent, ec);
+                }
+            }
+            else
+            {
+                // 서버가 끊으면 0 바이트 (또는 리셋)
+                char buf[64];
+                for (std::size_t received = 1; !ec && 0 != received;)
+                    sock.receive(buf, sizeof(buf), received, ec);
+            }
+
+            lasted[c].store(std::max<Clock::rep>(1, (Clock::now() - silent_since).count()));
+            closed.fetch_add(1);
+        }).detach();
+    }
+
+    const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double>(options.seconds));
+    while (closed.load() < options.connections && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (const bool stalled : {false, true})
+    {
+        unsigned total = 0, count = 0;
+        Clock::duration longest{};
+        for (unsigned c = stalled; c < options.connections; c += 2, ++total)
+        {
+            if (const Clock::rep rep = lasted[c].load())
+            {
+                ++count;
+                longest = std::max(longest, Clock::duration(rep));
+            }
+        }
+        std::cout << std::format("{}: {} of {} closed by the server, at most {:.1f}s after going silent\n",
+                                 stalled ? "stalled" : "idle", count, total,
+                                 std::chrono::duration<double>(longest).count());
+    }
+
+    // 막혀있는 스레드들은 그대로 두고 종료
+    if (closed.load() != options.connections)
+    {
+        std::cout << "Some were never closed" << std::endl;
+        std::exit(1);
+    }
+}
+
+struct IdleOptions
+{
+    unsigned connections;
+    double seconds; // to hold them open
+};
+
+/// Opens `connections` connections that never send anything, and holds them for `seconds` before closing them,
+/// for the server to report its footprint with that many idle sessions.
+///
+/// Keep `seconds` under the server's idle timeout (60s). One client reaches the server from as many ports
+/// as its ephemeral port range has (16384 by default on Windows): for 100k, widen it
+/// (`netsh int ipv4 set dynamicport tcp start=10000 num=55536`), and split them between clients connecting
+/// to `127.0.0.1`, `127.0.0.2`, ...
+/// Exits with failure unless every connection could be opened.
+void run_idle(const ds::SocketAddress& addr, const IdleOptions& options)
+{
+    // 소켓은 이동하지 않도록 deque 에 둠
+    std::deque<ds::TcpSocket> socks;
+    std::error_code ec;
+
+    const auto started = Clock::now();
+    while (socks.size() < options.connections)
+    {
+        socks.emplace_back().connect(addr, ec);
+        if (ec)
+        {
+            socks.pop_back();
+            break;
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    std::cout << std::format("{} of {} idle connections open in {:.1f}s{}, holding them for {}s\n", socks.size(),
+                             options.connections, elapsed.count(), ec ? ", then: " + ec.message() : "",
+                             options.seconds);
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+
+    const bool all_opened = socks.size() == options.connections;
+    socks.clear();
+    if (!all_opened)
+        std::exit(1);
+}
+
+/// Usage: 07_iocp_echo_client [<IPv4 address>] [--pipeline <depth> <message size> <seconds>]
+///                            [--churn <threads> <seconds>] [--silent <connections> <seconds>]
+///                            [--idle <connections> <seconds>]
+///
+/// Without `--pipeline`, `--churn`, `--silent` or `--idle`, echoes each line of stdin.
 int main(int argc, char** argv)
 {
-    if (argc != 1 && argc != 2)
+    const char* host = "localhost";
+    std::optional<PipelineOptions> pipeline;
+    std::optional<ChurnOptions> churn;
+    std::optional<SilentOptions> silent;
+    std::optional<IdleOptions> idle;
+
+    for (int i = 1; i < argc; ++i)
     {
-        std::cout << "Usage: 07_iocp_echo_client <IPv4 address>" << std::endl;
-        return 1;
+        const std::string_view arg = argv[i];
+        if (arg == "--pipeline" && i + 3 < argc && std::atoi(argv[i + 1]) > 0 && std::atoi(argv[i + 2]) > 0)
+        {
+            pipeline = PipelineOptions{static_cast<unsigned>(std::atoi(argv[i + 1])),
+                                       static_cast<std::size_t>(std::atoi(argv[i + 2])), std::atof(argv[i + 3])};
+            i += 3;
+        }
+        else if (arg == "--churn" && i + 2 < argc && std::atoi(argv[i + 1]) > 0)
+        {
+            churn = ChurnOptions{static_cast<unsigned>(std::atoi(argv[i + 1])), std::atof(argv[i + 2])};
+            i += 2;
+        }
+        else if (arg == "--silent" && i + 2 < argc && std::atoi(argv[i + 1]) > 0)
+        {
+            silent = SilentOptions{static_cast<unsigned>(std::atoi(argv[i + 1])), std::atof(argv[i + 2])};
+            i += 2;
+        }
+        else if (arg == "--idle" && i + 2 < argc && std::atoi(argv[i + 1]) > 0)
+        {
+            idle = IdleOptions{static_cast<unsigned>(std::atoi(argv[i + 1])), std::atof(argv[i + 2])};
+            i += 2;
+        }
+        else if (1 == i && !arg.starts_with("--"))
+        {
+            host = argv[i];
+        }
+        else
+        {
+            std::cout << "Usage: 07_iocp_echo_client [<IPv4 address>] [--pipeline <depth> <message size> <seconds>]"
+                         " [--churn <threads> <seconds>] [--silent <connections> <seconds>]"
+                         " [--idle <connections> <seconds>]"
+                      << std::endl;
+            return 1;
+        }
     }
 
     std::error_code ec;
@@ -23,14 +359,43 @@ int main(int argc, char** argv)
     ds::System::init(ec);
     check_ec(ec);
 
-    auto addr = ds::SocketAddress::resolve(argc == 2 ? argv[1] : "localhost", PORT_STR, ds::IpVersion::V4, ec);
+    auto addr = ds::SocketAddress::resolve(host, PORT_STR, ds::IpVersion::V4, ec);
     if (!addr)
         check_ec(ec);
 
+    if (churn)
+    {
+        run_churn(*addr, *churn);
+        ds::System::destroy();
+        return 0;
+    }
+
+    if (silent)
+    {
+        run_silent(*addr, *silent);
+        ds::System::destroy();
+        return 0;
+    }
+
+    if (idle)
+    {
+        run_idle(*addr, *idle);
+        ds::System::destroy();
+        return 0;
+    }
+
     ds::TcpSocket sock;
     sock.connect(*addr, ec);
     check_ec(ec);
 
+    if (pipeline)
+    {
+        run_pipeline(sock, *pipeline);
+        sock.close();
+        ds::System::destroy();
+        return 0;
+    }
+
     std::string input;
     std::string echoed;
 
@@ -0,0 +1,232 @@
+#include "Framing.hpp"
+#include "SessionBuffer.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t DEFAULT_TOTAL_BYTES = 32 * 1024 * 1024;
+static constexpr std::size_t MAX_MESSAGES = 500'000;
+
+// 메시지 내용은 251 개마다 반복 (메시지마다 시작 바이트가 다름)
+static constexpr std::size_t PATTERN_PERIOD = 251;
+
+static constexpr std::size_t FRAMED_RING_BUF_SIZE = 2 * (MAX_FRAME_HEADER_SIZE + MAX_MESSAGE_SIZE);
+
+enum class SendMode
+{
+    PER_MESSAGE, // one `writev()` per reply: its prefix and its message
+    COALESCED,   // every reply parsed from one receive in one `writev()` (`ReplyBatch`)
+};
+
+struct BenchResult
+{
+    std::uint64_t messages;
+    std::uint64_t syscalls;
+    double seconds;
+    bool verified;
+};
+
+[[noreturn]] void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+/// `PATTERN_PERIOD` framed messages of `size` bytes each, back to back: the bytes the producer sends,
+/// and the bytes the consumer must get back, over and over.
+auto make_stream(std::size_t size) -> std::vector<std::byte>
+{
+    std::vector<std::byte> stream;
+    for (std::size_t k = 0; k < PATTERN_PERIOD; ++k)
+    {
+        std::byte header[MAX_FRAME_HEADER_SIZE];
+        const std::size_t header_size = write_frame_header(size, header);
+        stream.insert(stream.end(), header, header + header_size);
+        for (std::size_t i = 0; i < size; ++i)
+            stream.push_back(static_cast<std::byte>((k + i) % PATTERN_PERIOD));
+    }
+    return stream;
+}
+
+/// Sends the whole batch, in as many `writev()`s as the socket takes.
+void send_all(int fd, ReplyBatch& replies, std::uint64_t& syscalls)
+{
+    while (!replies.empty())
+    {
+        iovec iov[ReplyBatch::MAX_PIECES];
+        std::size_t count = 0;
+        for (const ReplyBatch::Piece piece : replies.pieces())
+            iov[count++] = {const_cast<std::byte*>(piece.data()), piece.size()};
+
+        const ssize_t sent = writev(fd, iov, static_cast<int>(count));
+        ++syscalls;
+        if (sent < 0)
+            throw_errno("writev");
+        replies.consume(static_cast<std::size_t>(sent));
+    }
+}
+
+/// Echo loop of one framed session, as `EpollWorker` does it: receive into the ring buffer, parse the messages
+/// in place, reply, and release their room only once the replies are sent.
+template <SendMode Mode>
+auto relay(nb::RingByteBuffer<>& buf, int in_fd, int out_fd, std::uint64_t messages) -> std::uint64_t
+{
+    std::uint64_t syscalls = 0;
+    ReplyBatch replies;
+
+    for (std::uint64_t echoed = 0; echoed < messages;)
+    {
+        const IoSegments free = free_segments(buf);
+        iovec iov[2] = {{free.parts[0].data(), free.parts[0].size()}, {free.parts[1].data(), free.parts[1].size()}};
+        const ssize_t received = readv(in_fd, iov, static_cast<int>(free.count));
+        ++syscalls;
+        if (received <= 0)
+            throw_errno("readv");
+        buf.move_write_pos(static_cast<std::size_t>(received));
+
+        FrameParser parser(filled_segments(buf));
+        for (;;)
+        {
+            // 배치가 차면 보내고 나서 이어서 파싱
+            while (!replies.full())
+            {
+                const std::optional<IoSegments> message = parser.next();
+                if (!message)
+                    break;
+                ++echoed;
+                replies.add(*message);
+
+                if constexpr (Mode == SendMode::PER_MESSAGE)
+                    send_all(out_fd, replies, syscalls);
+            }
+            if (parser.malformed())
+                throw std::runtime_error("malformed message");
+            if (replies.empty())
+                break;
+            send_all(out_fd, replies, syscalls);
+        }
+        buf.move_read_pos(parser.parsed());
+    }
+
+    return syscalls;
+}
+
+template <SendMode Mode>
+auto bench(std::size_t size, std::uint64_t messages) -> BenchResult
+{
+    int in_fds[2], out_fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, in_fds) || socketpair(AF_UNIX, SOCK_STREAM, 0, out_fds))
+        throw_errno("socketpair");
+
+    const std::vector<std::byte> stream = make_stream(size);
+    const std::size_t wire_size = stream.size() / PATTERN_PERIOD;
+    const std::size_t total_bytes = messages * wire_size;
+
+    // producer: the messages back to back, in chunks that don't line up with them
+    std::jthread producer([&]() {
+        for (std::size_t pos = 0; pos < total_bytes;)
+        {
+            const std::size_t offset = pos % stream.size();
+            const std::size_t length = std::min(stream.size() - offset, total_bytes - pos);
+            const ssize_t result = send(in_fds[0], stream.data() + offset, length, 0);
+            if (result < 0)
+                throw_errno("producer send");
+            pos += static_cast<std::size_t>(result);
+        }
+    });
+
+    // consumer: every message back, in order
+    bool verified = true;
+    std::jthread consumer([&]() {
+        std::vector<std::byte> chunk(64 * 1024);
+        for (std::size_t pos = 0; pos < total_bytes;)
+        {
+            const ssize_t result = recv(out_fds[1], chunk.data(), chunk.size(), 0);
+            if (result <= 0)
+            {
+                verified = false;
+                break;
+            }
+            for (std::size_t i = 0; i < static_cast<std::size_t>(result);)
+            {
+                const std::size_t offset = (pos + i) % stream.size();
+                const std::size_t length = std::min(stream.size() - offset, static_cast<std::size_t>(result) - i);
+                if (0 != std::memcmp(chunk.data() + i, stream.data() + offset, length))
+                    verified = false;
+                i += length;
+            }
+            pos += static_cast<std::size_t>(result);
+        }
+    });
+
+    nb::RingByteBuffer<> buf(FRAMED_RING_BUF_SIZE);
+
+    const auto started = Clock::now();
+    const std::uint64_t syscalls = relay<Mode>(buf, in_fds[1], out_fds[0], messages);
+    producer.join();
+    consumer.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    for (const int fd : {in_fds[0], in_fds[1], out_fds[0], out_fds[1]})
+        close(fd);
+
+    return {messages, syscalls, elapsed.count(), verified};
+}
+
+/// Usage: 07_framing_bench [total bytes per run]
+int main(int argc, char** argv)
+{
+    const std::size_t total_bytes = (argc == 2) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_TOTAL_BYTES;
+    if (argc > 2 || 0 == total_bytes)
+    {
+        std::cout << "Usage: 07_framing_bench [total bytes per run]" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format("echoing length-prefixed messages through a {} byte ring buffer, "
+                             "up to {:.1f} MiB or {} messages per run\n",
+                             FRAMED_RING_BUF_SIZE, total_bytes / (1024.0 * 1024.0), MAX_MESSAGES);
+    std::cout << std::format("{:>6} | {:>14} | {:>12} | {:>12} | {:>10}\n", "size", "sends", "msgs/s", "syscalls/msg",
+                             "MiB/s");
+
+    bool all_is_well = true;
+
+    auto report = [&](std::size_t size, const char* name, const BenchResult& result) {
+        std::cout << std::format("{:>6} | {:>14} | {:>12.0f} | {:>12.2f} | {:>10.1f}\n", size, name,
+                                 result.messages / result.seconds, double(result.syscalls) / result.messages,
+                                 result.messages * size / (1024.0 * 1024.0) / result.seconds);
+        all_is_well = all_is_well && result.verified;
+    };
+
+    for (const std::size_t size : {16, 64, 256, 1024, 4096})
+    {
+        std::byte header[MAX_FRAME_HEADER_SIZE];
+        const std::size_t wire_size = write_frame_header(size, header) + size;
+        const std::uint64_t messages = std::max<std::uint64_t>(1, std::min(total_bytes / wire_size, MAX_MESSAGES));
+
+        report(size, "per message", bench<SendMode::PER_MESSAGE>(size, messages));
+        report(size, "coalesced", bench<SendMode::COALESCED>(size, messages));
+    }
+
+    if (!all_is_well)
+        std::cout << "verification failed!" << std::endl;
+    return !all_is_well;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+[[noreturn]] inline void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+/// Owning file descriptor.
+class UniqueFd
+{
+public:
+    UniqueFd() = default;
+
+    explicit UniqueFd(int fd) : _fd(fd)
+    {
+    }
+
+    ~UniqueFd()
+    {
+        reset();
+    }
+
+    UniqueFd(UniqueFd&& other) noexcept : _fd(std::exchange(other._fd, -1))
+    {
+    }
+
+    UniqueFd& operator=(UniqueFd&& other) noexcept
+    {
+        if (this != &other)
+            reset(std::exchange(other._fd, -1));
+        return *this;
+    }
+
+    UniqueFd(const UniqueFd&) = delete;
+    UniqueFd& operator=(const UniqueFd&) = delete;
+
+public:
+    auto get() const -> int
+    {
+        return _fd;
+    }
+
+    explicit operator bool() const
+    {
+        return _fd >= 0;
+    }
+
+    void reset(int fd = -1)
+    {
+        if (_fd >= 0)
+            ::close(_fd);
+        _fd = fd;
+    }
+
+private:
+    int _fd = -1;
+};
+
+/// Non-blocking IPv4 TCP listener on `port`.
+/// With `reuse_port`, several threads can each have their own listener on the same port.
+inline auto listen_tcp(std::uint16_t port, bool reuse_port = false) -> UniqueFd
+{
+    UniqueFd listener(::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    if (!listener)
+        throw_errno("socket");
+
+    const int enable = 1;
+    if (setsockopt(listener.get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)))
+        throw_errno("SO_REUSEADDR");
+    if (reuse_port && setsockopt(listener.get(), SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)))
+        throw_errno("SO_REUSEPORT");
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(listener.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)))
+        throw_errno("bind");
+    if (listen(listener.get(), SOMAXCONN))
+        throw_errno("listen");
+
+    return listener;
+}
+
+/// No nagle, so that small echoes go out right away.
+/// @return `false` if it failed, e.g. the peer already reset the connection: drop just that one
+inline bool set_no_delay(int fd)
+{
+    const int enable = 1;
+    return 0 == setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+// 자원이 모자라 accept 를 쉬는 시간
+static constexpr auto ACCEPT_BACKOFF = std::chrono::milliseconds(100);
+
+/// `accept4()` errors of the process or the system running out of fds or memory: the listener is fine,
+/// so back off for a while and keep serving the sessions already accepted, instead of giving up.
+inline bool is_out_of_resources(int error)
+{
+    return EMFILE == error || ENFILE == error || ENOBUFS == error || ENOMEM == error;
+}
+
+/// Accepted sockets handed over from the acceptor thread to a worker, which is woken through an eventfd.
+class SessionInbox
+{
+public:
+    SessionInbox() : _event(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+        if (!_event)
+            throw_errno("eventfd");
+    }
+
+    ~SessionInbox()
+    {
+        for (const int fd : _fds)
+            ::close(fd);
+    }
+
+public:
+    /// Any thread; the worker owns `fd` from now on.
+    void push(int fd)
+    {
+        {
+            std::lock_guard guard(_lock);
+            _fds.push_back(fd);
+        }
+        wake();
+    }
+
+    void wake()
+    {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const auto written = ::write(_event.get(), &one, sizeof(one));
+    }
+
+    /// Worker thread: resets the eventfd, and takes the queued sockets.
+    void take(std::vector<int>& fds)
+    {
+        std::uint64_t count;
+        [[maybe_unused]] const auto read = ::read(_event.get(), &count, sizeof(count));
+
+        fds.clear();
+        std::lock_guard guard(_lock);
+        fds.swap(_fds);
+    }
+
+    auto event_fd() const -> int
+    {
+        return _event.get();
+    }
+
+private:
+    UniqueFd _event;
+    std::mutex _lock;
+    std::vector<int> _fds;
+};
+
+/// When a worker closes a session on its own, as the peer is presumably dead or stuck.
+struct SessionTimeouts
+{
+    // nothing received for this long, with nothing left to echo
+    std::chrono::steady_clock::duration idle = std::chrono::seconds(60);
+
+    // echoes waiting to go out, but the peer took none of them for this long
+    std::chrono::steady_clock::duration write_stall = std::chrono::seconds(10);
+};
+
+/// Counters of a worker event loop, written by the worker and read by the main thread.
+struct WorkerStats
+{
+    std::atomic<std::uint64_t> sessions = 0;
+    std::atomic<std::uint64_t> bytes = 0;       // echoed back
+    std::atomic<std::uint64_t> echoes = 0;      // receives with data
+    std::atomic<std::uint64_t> messages = 0;    // handled, with the framed protocol
+    std::atomic<std::uint64_t> syscalls = 0;    // every syscall on the I/O path, including the waits
+    std::atomic<std::uint64_t> waits = 0;       // syscalls that reaped completions (`epoll_wait()`, `io_uring_enter()`)
+    std::atomic<std::uint64_t> completions = 0; // events or CQEs reaped by them
+    std::atomic<std::uint64_t> idle_timeouts = 0;
+    std::atomic<std::uint64_t> stall_timeouts = 0;
+    std::atomic<std::uint64_t> accept_failures = 0;    // out of fds or memory, on the worker's own listener
+    std::atomic<std::uint64_t> zerocopy_sends = 0;     // with `MSG_ZEROCOPY`
+    std::atomic<std::uint64_t> zerocopy_completed = 0; // ... that the kernel is done with
+    std::atomic<std::uint64_t> zerocopy_copied = 0;    // ... by copying, after all
+
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t value = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
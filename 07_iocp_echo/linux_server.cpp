@@ -0,0 +1,323 @@
+#include "EpollBackend.hpp"
+#include "UringBackend.hpp"
+#include "linux_common.hpp"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+static constexpr std::uint16_t PORT = 32983;
+
+// 종료 시각을 확인하는 주기
+static constexpr int ACCEPT_POLL_TIMEOUT_MS = 100;
+
+enum class Backend
+{
+    EPOLL,
+    URING,
+};
+
+enum class AcceptMode
+{
+    MAIN,    // the main thread accepts, and hands the sessions to the workers in turn
+    WORKERS, // every worker accepts on its own `SO_REUSEPORT` listener
+};
+
+struct Options
+{
+    Backend backend = Backend::EPOLL;
+    AcceptMode accept = AcceptMode::MAIN;
+    unsigned workers = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
+    unsigned batch = 256; // completions reaped per wait
+    bool framed = false;  // length-prefixed messages, instead of raw bytes
+    // smallest echo sent with `MSG_ZEROCOPY`, 0 to always copy
+    std::size_t zerocopy_threshold = 0;
+    SessionTimeouts timeouts;
+    std::optional<Clock::duration> run_duration;
+};
+
+auto to_duration(const char* seconds) -> Clock::duration
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::atof(seconds)));
+}
+
+/// User + system CPU time of the whole process so far, in seconds.
+auto cpu_seconds() -> double
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](const timeval& time) { return time.tv_sec + time.tv_usec / 1e6; };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+/// Usage: 07_linux_echo_server [--backend epoll|uring] [--accept main|workers] [--workers <count>]
+///                              [--batch <completions>] [--idle-timeout <seconds>] [--stall-timeout <seconds>]
+///                              [--framed] [--zerocopy <bytes>] [--duration <seconds>]
+///
+/// Without `--duration`, runs until killed.
+/// A session that sends nothing for `--idle-timeout` (60s by default), or doesn't read its echoes
+/// for `--stall-timeout` (10s by default), is closed.
+/// `--accept workers` lets the kernel spread the connections over the workers' listeners, by their address hash.
+/// `--backend uring` falls back to epoll if the kernel lacks the io_uring features it needs.
+/// `--framed` echoes length-prefixed messages (see `Framing.hpp`) one by one, instead of raw bytes; epoll only.
+/// `--zerocopy` sends raw echoes of at least that many bytes with `MSG_ZEROCOPY` (see `ZeroCopy.hpp`), from a larger
+/// ring buffer; epoll only. Compare the CPU per GiB with a threshold above the ring buffer size, which always copies.
+auto parse_options(int argc, char** argv) -> Options
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const std::string_view value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--backend" && (value == "epoll" || value == "uring"))
+        {
+            options.backend = (value == "uring") ? Backend::URING : Backend::EPOLL;
+            ++i;
+        }
+        else if (arg == "--accept" && (value == "main" || value == "workers"))
+        {
+            options.accept = (value == "workers") ? AcceptMode::WORKERS : AcceptMode::MAIN;
+            ++i;
+        }
+        else if (arg == "--workers" && std::atoi(value.data()) > 0)
+        {
+            options.workers = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--batch" && std::atoi(value.data()) > 0)
+        {
+            options.batch = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--idle-timeout" && std::atof(value.data()) > 0)
+        {
+            options.timeouts.idle = to_duration(argv[++i]);
+        }
+        else if (arg == "--stall-timeout" && std::atof(value.data()) > 0)
+        {
+            options.timeouts.write_stall = to_duration(argv[++i]);
+        }
+        else if (arg == "--framed")
+        {
+            options.framed = true;
+        }
+        else if (arg == "--zerocopy" && std::atol(value.data()) > 0)
+        {
+            options.zerocopy_threshold = static_cast<std::size_t>(std::atol(argv[++i]));
+        }
+        else if (arg == "--duration" && !value.empty())
+        {
+            options.run_duration = to_duration(argv[++i]);
+        }
+        else
+        {
+            std::cout << "Usage: 07_linux_echo_server [--backend epoll|uring] [--accept main|workers] "
+                         "[--workers <count>] [--batch <completions>] [--idle-timeout <seconds>] "
+                         "[--stall-timeout <seconds>] [--framed] [--zerocopy <bytes>] [--duration <seconds>]"
+                      << std::endl;
+            std::exit(1);
+        }
+    }
+
+    return options;
+}
+
+template <typename Worker, typename Acceptor>
+void run(const Options& options)
+{
+    std::deque<Worker> workers;
+    for (unsigned i = 0; i < options.workers; ++i)
+    {
+        auto& worker = workers.emplace_back(options.batch, options.timeouts);
+        if constexpr (std::is_same_v<Worker, EpollWorker>)
+        {
+            if (options.framed)
+                worker.use_framing();
+            if (options.zerocopy_threshold)
+                worker.use_zerocopy(options.zerocopy_threshold);
+        }
+    }
+
+    // 워커마다 자기 리스너를 두면, 커널이 주소 해시로 연결을 나눠줌
+    std::vector<UniqueFd> worker_listeners;
+    if (AcceptMode::WORKERS == options.accept)
+    {
+        for (auto& worker : workers)
+            worker.accept_on(worker_listeners.emplace_back(listen_tcp(PORT, true)).get());
+    }
+
+    std::vector<std::jthread> threads;
+    threads.reserve(options.workers);
+    for (auto& worker : workers)
+        threads.emplace_back([&worker]() { worker.run(); });
+
+    // 예외로 빠져나가도 워커를 멈춰야, `threads` 소멸자의 join 이 돌아옴
+    struct StopWorkers
+    {
+        std::deque<Worker>& workers;
+
+        ~StopWorkers()
+        {
+            for (auto& worker : workers)
+                worker.stop();
+        }
+    } stop_workers{workers};
+
+    std::cout << std::format("listening on port {} ({} {} workers, batches of {}, accepting on {}{}{})\n", PORT,
+                             options.workers, (Backend::URING == options.backend) ? "io_uring" : "epoll",
+                             options.batch, (AcceptMode::WORKERS == options.accept) ? "workers" : "main thread",
+                             options.framed ? ", framed messages" : "",
+                             options.zerocopy_threshold
+                                 ? std::format(", zero-copy from {} bytes", options.zerocopy_threshold)
+                                 : std::string());
+
+    const auto started = Clock::now();
+    const double cpu_started = cpu_seconds();
+    auto running = [&]() { return !options.run_duration || Clock::now() - started < *options.run_duration; };
+
+    if (AcceptMode::WORKERS == options.accept)
+    {
+        while (running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_POLL_TIMEOUT_MS));
+    }
+    else
+    {
+        const UniqueFd listener = listen_tcp(PORT);
+        Acceptor acceptor(listener.get());
+        std::size_t next_worker = 0;
+        std::vector<int> accepted;
+
+        // accept new session, and hand it to the workers in turn
+        while (running())
+        {
+            accepted.clear();
+            acceptor.accept(accepted, ACCEPT_POLL_TIMEOUT_MS);
+            for (const int sock : accepted)
+            {
+                if (!set_no_delay(sock))
+                {
+                    ::close(sock);
+                    continue;
+                }
+                workers[next_worker].add_session(sock);
+                next_worker = (next_worker + 1) % workers.size();
+            }
+        }
+    }
+
+    for (auto& worker : workers)
+        worker.stop();
+    for (auto& thread : threads)
+        thread.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+    const double cpu = cpu_seconds() - cpu_started;
+
+    std::uint64_t sessions = 0, bytes = 0, echoes = 0, syscalls = 0, waits = 0, completions = 0;
+    std::uint64_t idle_timeouts = 0, stall_timeouts = 0, messages = 0, accept_failures = 0;
+    std::uint64_t zerocopy_sends = 0, zerocopy_completed = 0, zerocopy_copied = 0;
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        const WorkerStats& stats = workers[i].stats();
+        std::cout << std::format("Worker #{}: {} sessions, {} bytes echoed in {} receives, {} syscalls\n", i,
+                                 stats.sessions.load(), stats.bytes.load(), stats.echoes.load(),
+                                 stats.syscalls.load());
+        sessions += stats.sessions.load();
+        bytes += stats.bytes.load();
+        echoes += stats.echoes.load();
+        syscalls += stats.syscalls.load();
+        waits += stats.waits.load();
+        completions += stats.completions.load();
+        idle_timeouts += stats.idle_timeouts.load();
+        stall_timeouts += stats.stall_timeouts.load();
+        messages += stats.messages.load();
+        accept_failures += stats.accept_failures.load();
+        zerocopy_sends += stats.zerocopy_sends.load();
+        zerocopy_completed += stats.zerocopy_completed.load();
+        zerocopy_copied += stats.zerocopy_copied.load();
+    }
+    std::cout << std::format("{:.1f} MiB/s echoed over {:.1f}s, {:.0f} sessions/s accepted\n",
+                             bytes / elapsed.count() / (1024 * 1024), elapsed.count(), sessions / elapsed.count());
+    if (echoes)
+        std::cout << std::format("{:.2f} syscalls per echo\n", static_cast<double>(syscalls) / echoes);
+    if (messages)
+        std::cout << std::format("{:.0f} msgs/s, {:.3f} syscalls per message\n", messages / elapsed.count(),
+                                 static_cast<double>(syscalls) / messages);
+    if (waits)
+        std::cout << std::format("{:.2f} completions per wait\n", static_cast<double>(completions) / waits);
+    if (bytes)
+        std::cout << std::format("{:.2f} CPU seconds per GiB echoed ({:.0f}% of a core)\n",
+                                 cpu / (bytes / (1024.0 * 1024 * 1024)), 100 * cpu / elapsed.count());
+    if (options.zerocopy_threshold)
+        std::cout << std::format("{} zero-copy sends, {} completed, {} of them copied by the kernel after all\n",
+                                 zerocopy_sends, zerocopy_completed, zerocopy_copied);
+    std::cout << std::format("{} sessions timed out idle, {} stalled on sending\n", idle_timeouts, stall_timeouts);
+    if (accept_failures)
+        std::cout << std::format("{} accepts on the workers failed for lack of fds or memory\n", accept_failures);
+}
+
+int main(int argc, char** argv)
+{
+    Options options = parse_options(argc, argv);
+
+    // 리셋된 소켓에 쓰면 에러만 받고 계속 진행
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (Backend::URING == options.backend)
+    {
+        try
+        {
+            UringWorker::require_support();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << std::format("io_uring unavailable ({}), falling back to epoll\n", e.what());
+            options.backend = Backend::EPOLL;
+        }
+    }
+    if (Backend::URING == options.backend && options.framed)
+    {
+        std::cout << "framed messages run on epoll only, falling back to epoll\n";
+        options.backend = Backend::EPOLL;
+    }
+    if (Backend::URING == options.backend && options.zerocopy_threshold)
+    {
+        std::cout << "zero-copy sends run on epoll only, falling back to epoll\n";
+        options.backend = Backend::EPOLL;
+    }
+    if (options.framed && options.zerocopy_threshold)
+    {
+        std::cout << "framed replies are always copied, ignoring --zerocopy\n";
+        options.zerocopy_threshold = 0;
+    }
+
+    try
+    {
+        if (Backend::URING == options.backend)
+            run<UringWorker, UringAcceptor>(options);
+        else
+            run<EpollWorker, PollAcceptor>(options);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Goodbye!" << std::endl;
+}
@@ -0,0 +1,532 @@
+#include "Framing.hpp"
+#include "common.hpp"
+
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+
+#include <vtp/HdrHistogram.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#else
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#endif
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+static constexpr const char* PORT_STR = "32983";
+
+// 끝난 뒤 아직 안 돌아온 에코를 기다리는 시간
+static constexpr auto DRAIN_TIMEOUT = 2s;
+
+// 보내는 쪽이 할 일 없을 때 최대로 기다리는 시간
+static constexpr int IDLE_POLL_TIMEOUT_MS = 100;
+
+static constexpr std::size_t RECV_CHUNK = 64 * 1024;
+
+// message `k` of connection `c` is `PATTERN[(c * 17 + k) % PATTERN_PERIOD ...]`,
+// so a lost, repeated or reordered byte never lines up with what's expected
+static constexpr std::size_t PATTERN_PERIOD = 251;
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+static constexpr int SEND_FLAGS = 0;
+
+static auto poll_sockets(std::span<pollfd> fds, int timeout_ms) -> int
+{
+    return WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout_ms);
+}
+
+static bool would_block()
+{
+    return WSAEWOULDBLOCK == WSAGetLastError();
+}
+#else
+using NativeSocket = int;
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+
+static auto poll_sockets(std::span<pollfd> fds, int timeout_ms) -> int
+{
+    return ::poll(fds.data(), fds.size(), timeout_ms);
+}
+
+static bool would_block()
+{
+    return EAGAIN == errno || EWOULDBLOCK == errno;
+}
+#endif
+
+struct Options
+{
+    const char* host = "localhost";
+    unsigned connections = 64;
+    unsigned threads = 1;
+    std::size_t message_size = 64;
+    unsigned depth = 1;         // closed loop: messages outstanding per connection
+    std::optional<double> rate; // open loop: messages/s over all connections
+    double seconds = 5;
+    double warmup = 0;   // not recorded
+    bool framed = false; // each message length-prefixed, `size` not counting the prefix
+};
+
+/// Usage: 07_echo_load_client [<IPv4 address>] [--connections <n>] [--threads <n>] [--size <bytes>]
+///                            [--depth <messages>] [--rate <messages/s>] [--duration <seconds>] [--warmup <seconds>]
+///                            [--framed]
+///
+/// Without `--rate`, runs closed loop: each connection keeps `depth` messages outstanding, sending the next one
+/// as soon as an echo is back.
+/// With `--rate`, runs open loop: each connection sends on a fixed schedule regardless of the echoes,
+/// and latency counts from when a message was due, not when it went out, so that a stalled server
+/// shows up in the latencies instead of silently slowing the client down (coordinated omission).
+/// With `--framed`, each message goes with its length prefix, for a server echoing length-prefixed messages.
+auto parse_options(int argc, char** argv) -> Options
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const char* const value = (i + 1 < argc) ? argv[i + 1] : "";
+        const bool positive = std::atof(value) > 0;
+        if (arg == "--connections" && positive)
+            options.connections = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--threads" && positive)
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--size" && positive)
+            options.message_size = static_cast<std::size_t>(std::atoi(argv[++i]));
+        else if (arg == "--depth" && positive)
+            options.depth = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--rate" && positive)
+            options.rate = std::atof(argv[++i]);
+        else if (arg == "--duration" && positive)
+            options.seconds = std::atof(argv[++i]);
+        else if (arg == "--warmup" && *value)
+            options.warmup = std::atof(argv[++i]);
+        else if (arg == "--framed")
+            options.framed = true;
+        else if (1 == i && !arg.starts_with("--"))
+            options.host = argv[i];
+        else
+        {
+            std::cout << "Usage: 07_echo_load_client [<IPv4 address>] [--connections <n>] [--threads <n>] "
+                         "[--size <bytes>] [--depth <messages>] [--rate <messages/s>] [--duration <seconds>] "
+                         "[--warmup <seconds>] [--framed]"
+                      << std::endl;
+            std::exit(1);
+        }
+    }
+    if (options.framed && options.message_size > MAX_MESSAGE_SIZE)
+    {
+        std::cout << std::format("framed messages are {} bytes at most", MAX_MESSAGE_SIZE) << std::endl;
+        std::exit(1);
+    }
+
+    options.threads = std::min(options.threads, options.connections);
+    return options;
+}
+
+struct Connection
+{
+    ds::TcpSocket sock;
+    NativeSocket handle;
+    unsigned index;
+
+    std::uint64_t started = 0; // messages due to be sent
+    std::uint64_t sent = 0;    // messages fully sent
+    std::size_t send_offset = 0;
+    std::uint64_t echoed = 0;
+    std::size_t recv_offset = 0;
+
+    // latency of each message not echoed yet counts from here: when it was due (open loop) or sent (closed loop)
+    std::deque<Clock::time_point> start_times;
+    Clock::time_point next_due;
+
+    bool closed = false;
+};
+
+struct ThreadResult
+{
+    vtp::HdrHistogram latency; // ns
+    std::uint64_t messages = 0;
+    std::uint64_t lost = 0;      // not echoed back before the drain timed out
+    std::uint64_t corrupted = 0; // connections that echoed back something else
+    std::uint64_t dropped = 0;   // connections closed by the server, or failed
+};
+
+/// Drives its share of the connections with non-blocking sockets and `poll()`, until `end` plus the drain.
+class LoadThread
+{
+public:
+    /// @param messages message `k` as sent is `wire_size` bytes from `k * stride`
+    LoadThread(const Options& options, const ds::SocketAddress& addr, std::span<const unsigned> indexes,
+               std::span<const char> messages, std::size_t stride, std::size_t wire_size, ThreadResult& result)
+        : _options(options), _messages(messages), _stride(stride), _wire_size(wire_size), _result(result),
+          _recv_buf(RECV_CHUNK)
+    {
+        std::error_code ec;
+        for (const unsigned index : indexes)
+        {
+            Connection& conn = _conns.emplace_back();
+            conn.index = index;
+            conn.sock.connect(addr, ec);
+            check_ec(ec);
+            conn.sock.set_non_blocking(true, ec);
+            check_ec(ec);
+            conn.handle = conn.sock.get_handle();
+
+            // no nagle
+            const int enable = true;
+            setsockopt(conn.handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+        }
+    }
+
+public:
+    void run(Clock::time_point started, Clock::time_point record_from, Clock::time_point end)
+    {
+        // 연결마다 시작 시각을 흩뜨려, 모두가 같은 순간에 보내지 않게 함
+        const auto interval = _options.rate ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                                                  _options.connections / *_options.rate))
+                                            : Clock::duration::zero();
+        for (Connection& conn : _conns)
+            conn.next_due = started + interval * conn.index / _options.connections;
+
+        _record_from = record_from;
+        _end = end;
+
+        for (auto now = Clock::now(); now < end + DRAIN_TIMEOUT && (now < end || outstanding()); now = Clock::now())
+        {
+            if (now < end)
+            {
+                for (Connection& conn : _conns)
+                    schedule(conn, now, interval);
+            }
+
+            for (Connection& conn : _conns)
+                flush(conn);
+
+            wait(now);
+        }
+
+        for (const Connection& conn : _conns)
+        {
+            for (const Clock::time_point start : conn.start_times)
+                _result.lost += (start >= _record_from && start < _end);
+        }
+    }
+
+private:
+    /// Starts the messages due on `conn`.
+    void schedule(Connection& conn, Clock::time_point now, Clock::duration interval)
+    {
+        if (conn.closed)
+            return;
+
+        if (_options.rate)
+        {
+            for (; conn.next_due <= now; conn.next_due += interval)
+                start_message(conn, conn.next_due);
+        }
+        else
+        {
+            while (conn.started - conn.echoed < _options.depth)
+                start_message(conn, now);
+        }
+    }
+
+    void start_message(Connection& conn, Clock::time_point start)
+    {
+        conn.start_times.push_back(start);
+        ++conn.started;
+    }
+
+    auto message_of(const Connection& conn, std::uint64_t message) const -> std::span<const char>
+    {
+        const std::size_t offset = (conn.index * 17 + message) % PATTERN_PERIOD;
+        return _messages.subspan(offset * _stride, _wire_size);
+    }
+
+    /// Sends the started messages until the socket would block.
+    void flush(Connection& conn)
+    {
+        while (!conn.closed && conn.sent < conn.started)
+        {
+            const std::span<const char> rest = message_of(conn, conn.sent).subspan(conn.send_offset);
+            const auto sent = ::send(conn.handle, rest.data(), static_cast<int>(rest.size()), SEND_FLAGS);
+            if (sent < 0)
+            {
+                if (!would_block())
+                    drop(conn);
+                return;
+            }
+
+            conn.send_offset += static_cast<std::size_t>(sent);
+            if (conn.send_offset == _wire_size)
+            {
+                ++conn.sent;
+                conn.send_offset = 0;
+            }
+        }
+    }
+
+    /// Waits for echoes, or until the next message is due, and handles them.
+    void wait(Clock::time_point now)
+    {
+        _fds.clear();
+        _polled.clear();
+        for (Connection& conn : _conns)
+        {
+            if (conn.closed)
+                continue;
+
+            short events = POLLIN;
+            if (conn.sent < conn.started)
+                events |= POLLOUT;
+            _fds.push_back({conn.handle, events, 0});
+            _polled.push_back(&conn);
+        }
+        if (_fds.empty())
+            return;
+
+        if (poll_sockets(_fds, poll_timeout_ms(now)) <= 0)
+            return;
+
+        for (std::size_t i = 0; i < _fds.size(); ++i)
+        {
+            if (_fds[i].revents & (POLLIN | POLLERR | POLLHUP))
+                receive(*_polled[i]);
+        }
+    }
+
+    /// Closed loop only waits for echoes; open loop wakes up when the next message is due,
+    /// and spins through the last millisecond, so that it sends on time.
+    auto poll_timeout_ms(Clock::time_point now) const -> int
+    {
+        if (now >= _end)
+            return IDLE_POLL_TIMEOUT_MS;
+        if (!_options.rate)
+        {
+            const auto until_end = std::chrono::ceil<std::chrono::milliseconds>(_end - now).count();
+            return static_cast<int>(std::clamp<std::int64_t>(until_end, 1, IDLE_POLL_TIMEOUT_MS));
+        }
+
+        auto next_due = _end;
+        for (const Connection& conn : _conns)
+        {
+            if (!conn.closed)
+                next_due = std::min(next_due, conn.next_due);
+        }
+        const auto until_due = std::chrono::floor<std::chrono::milliseconds>(next_due - now).count();
+        return static_cast<int>(std::clamp<std::int64_t>(until_due, 0, IDLE_POLL_TIMEOUT_MS));
+    }
+
+    void receive(Connection& conn)
+    {
+        for (;;)
+        {
+            const auto received = ::recv(conn.handle, _recv_buf.data(), static_cast<int>(_recv_buf.size()), 0);
+            if (received < 0)
+            {
+                if (!would_block())
+                    drop(conn);
+                return;
+            }
+            if (0 == received)
+            {
+                drop(conn);
+                return;
+            }
+
+            const auto now = Clock::now();
+            if (!verify(conn, std::span(_recv_buf.data(), static_cast<std::size_t>(received)), now))
+            {
+                ++_result.corrupted;
+                drop(conn);
+                return;
+            }
+            if (static_cast<std::size_t>(received) < _recv_buf.size())
+                return;
+        }
+    }
+
+    /// Checks the echoed bytes against what was sent, and records the latency of each message completed.
+    bool verify(Connection& conn, std::span<const char> data, Clock::time_point now)
+    {
+        while (!data.empty())
+        {
+            // 보내지도 않은 걸 돌려받음
+            if (conn.echoed == conn.sent && conn.recv_offset + data.size() > conn.send_offset)
+                return false;
+
+            const std::size_t length = std::min(data.size(), _wire_size - conn.recv_offset);
+            if (0 != std::memcmp(data.data(), message_of(conn, conn.echoed).data() + conn.recv_offset, length))
+                return false;
+
+            data = data.subspan(length);
+            conn.recv_offset += length;
+            if (conn.recv_offset == _wire_size)
+            {
+                const Clock::time_point start = conn.start_times.front();
+                if (start >= _record_from && start < _end)
+                {
+                    _result.latency.record(now - start);
+                    ++_result.messages;
+                }
+
+                conn.start_times.pop_front();
+                ++conn.echoed;
+                conn.recv_offset = 0;
+            }
+        }
+        return true;
+    }
+
+    void drop(Connection& conn)
+    {
+        conn.closed = true;
+        conn.sock.close();
+        ++_result.dropped;
+
+        // 돌아오지 않을 메시지들은 유실로 셈
+        for (const Clock::time_point start : conn.start_times)
+            _result.lost += (start >= _record_from && start < _end);
+        conn.start_times.clear();
+    }
+
+    bool outstanding() const
+    {
+        return std::any_of(_conns.begin(), _conns.end(),
+                           [](const Connection& conn) { return !conn.closed && !conn.start_times.empty(); });
+    }
+
+private:
+    const Options& _options;
+    const std::span<const char> _messages;
+    const std::size_t _stride;
+    const std::size_t _wire_size;
+    ThreadResult& _result;
+
+    std::deque<Connection> _conns;
+    std::vector<pollfd> _fds;
+    std::vector<Connection*> _polled;
+    std::vector<char> _recv_buf;
+
+    Clock::time_point _record_from;
+    Clock::time_point _end;
+};
+
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
+
+    std::error_code ec;
+
+    ds::System::init(ec);
+    check_ec(ec);
+
+    auto addr = ds::SocketAddress::resolve(options.host, PORT_STR, ds::IpVersion::V4, ec);
+    if (!addr)
+        check_ec(ec);
+
+    std::vector<char> pattern(PATTERN_PERIOD + options.message_size);
+    for (std::size_t i = 0; i < pattern.size(); ++i)
+        pattern[i] = static_cast<char>(i % PATTERN_PERIOD);
+
+    // 메시지 `k` 는 패턴의 `k` 번째 바이트부터; 프레임 모드면 길이 접두어를 붙여 하나씩 펼쳐둠
+    std::byte header[MAX_FRAME_HEADER_SIZE];
+    const std::size_t header_size = options.framed ? write_frame_header(options.message_size, header) : 0;
+    const std::size_t wire_size = header_size + options.message_size;
+
+    std::vector<char> framed_messages;
+    if (options.framed)
+    {
+        framed_messages.reserve(PATTERN_PERIOD * wire_size);
+        for (std::size_t k = 0; k < PATTERN_PERIOD; ++k)
+        {
+            framed_messages.insert(framed_messages.end(), reinterpret_cast<const char*>(header),
+                                   reinterpret_cast<const char*>(header) + header_size);
+            framed_messages.insert(framed_messages.end(), pattern.begin() + k,
+                                   pattern.begin() + k + options.message_size);
+        }
+    }
+
+    // connection `i` goes to thread `i % threads`
+    std::vector<std::vector<unsigned>> indexes(options.threads);
+    for (unsigned i = 0; i < options.connections; ++i)
+        indexes[i % options.threads].push_back(i);
+
+    std::vector<ThreadResult> results(options.threads);
+    std::deque<LoadThread> loads;
+    for (unsigned t = 0; t < options.threads; ++t)
+    {
+        if (options.framed)
+            loads.emplace_back(options, *addr, indexes[t], framed_messages, wire_size, wire_size, results[t]);
+        else
+            loads.emplace_back(options, *addr, indexes[t], pattern, 1, wire_size, results[t]);
+    }
+
+    if (options.rate)
+        std::cout << std::format("{} connections on {} threads, {} bytes, open loop at {:.0f} msgs/s\n",
+                                 options.connections, options.threads, options.message_size, *options.rate);
+    else
+        std::cout << std::format("{} connections on {} threads, {} bytes, closed loop at depth {}\n",
+                                 options.connections, options.threads, options.message_size, options.depth);
+
+    const auto started = Clock::now();
+    const auto record_from = started + std::chrono::duration_cast<Clock::duration>(
+                                           std::chrono::duration<double>(options.warmup));
+    const auto end = record_from + std::chrono::duration_cast<Clock::duration>(
+                                       std::chrono::duration<double>(options.seconds));
+    {
+        std::vector<std::jthread> threads;
+        for (auto& load : loads)
+            threads.emplace_back([&]() { load.run(started, record_from, end); });
+    }
+
+    vtp::HdrHistogram latency;
+    std::uint64_t messages = 0, lost = 0, corrupted = 0, dropped = 0;
+    for (const ThreadResult& result : results)
+    {
+        latency.merge(result.latency);
+        messages += result.messages;
+        lost += result.lost;
+        corrupted += result.corrupted;
+        dropped += result.dropped;
+    }
+
+    std::cout << std::format("{:.0f} msgs/s, {:.1f} MiB/s echoed\n", messages / options.seconds,
+                             messages * options.message_size / options.seconds / (1024 * 1024));
+    std::cout << std::format(
+        "latency (us): mean {:.1f}, p50 {:.1f}, p90 {:.1f}, p99 {:.1f}, p99.9 {:.1f}, max {:.1f}\n",
+        latency.mean() / 1e3, latency.percentile(50) / 1e3, latency.percentile(90) / 1e3, latency.percentile(99) / 1e3,
+        latency.percentile(99.9) / 1e3, latency.max() / 1e3);
+
+    const bool all_is_well = (0 == lost && 0 == corrupted && 0 == dropped);
+    if (!all_is_well)
+        std::cout << std::format("{} messages lost, {} connections corrupted, {} connections dropped\n", lost,
+                                 corrupted, dropped);
+
+    loads.clear();
+    ds::System::destroy();
+    return !all_is_well;
+}
@@ -0,0 +1,214 @@
+#include <NetBuff/RingByteBuffer.hpp>
+#include <vtp/MirroredRingBuffer.hpp>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t RING_BUF_SIZE = 64 * 1024;
+static constexpr std::size_t DEFAULT_TOTAL_BYTES = 256 * 1024 * 1024;
+static constexpr std::size_t MAX_CHUNK_SIZE = 16 * 1024;
+
+enum class IoMode
+{
+    SPLIT,    // `nb::RingByteBuffer`, one `recv()`/`send()` per segment
+    VECTORED, // `nb::RingByteBuffer`, one `readv()`/`writev()` with two segments
+    MIRRORED, // `vtp::MirroredRingBuffer`, one `recv()`/`send()` always
+};
+
+struct BenchResult
+{
+    std::uint64_t syscalls;
+    double seconds;
+    bool verified;
+};
+
+[[noreturn]] void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+/// Relays `total_bytes` from `in_fd` to `out_fd` through `buf`, echo server style.
+template <IoMode Mode, typename Buffer>
+auto relay(Buffer& buf, int in_fd, int out_fd, std::size_t total_bytes) -> std::uint64_t
+{
+    std::uint64_t syscalls = 0;
+    std::size_t received_total = 0;
+
+    while (received_total < total_bytes || !buf.empty())
+    {
+        // receive into the free space
+        if (received_total < total_bytes && buf.available_space() > 0)
+        {
+            const std::size_t consecutive = buf.consecutive_write_length();
+            const std::size_t available = buf.available_space();
+            std::byte* const first = buf.data() + buf.write_pos();
+
+            ssize_t received;
+            if constexpr (Mode == IoMode::VECTORED)
+            {
+                iovec iov[2] = {{first, consecutive}, {buf.data(), available - consecutive}};
+                received = readv(in_fd, iov, (available > consecutive) ? 2 : 1);
+                ++syscalls;
+            }
+            else
+            {
+                received = recv(in_fd, first, consecutive, 0);
+                ++syscalls;
+                if constexpr (Mode == IoMode::SPLIT)
+                {
+                    // first segment filled up, try the second one without blocking
+                    if (received == static_cast<ssize_t>(consecutive) && available > consecutive)
+                    {
+                        buf.move_write_pos(static_cast<std::size_t>(received));
+                        received_total += static_cast<std::size_t>(received);
+
+                        received = recv(in_fd, buf.data(), available - consecutive, MSG_DONTWAIT);
+                        ++syscalls;
+                        if (received < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+                            received = 0;
+                    }
+                }
+            }
+            if (received < 0)
+                throw_errno("receive");
+
+            buf.move_write_pos(static_cast<std::size_t>(received));
+            received_total += static_cast<std::size_t>(received);
+        }
+
+        // send everything received
+        while (!buf.empty())
+        {
+            const std::size_t consecutive = buf.consecutive_read_length();
+            const std::size_t used = buf.used_space();
+            const std::byte* const first = buf.data() + buf.read_pos();
+
+            ssize_t sent;
+            if constexpr (Mode == IoMode::VECTORED)
+            {
+                iovec iov[2] = {{const_cast<std::byte*>(first), consecutive},
+                                {buf.data(), used - consecutive}};
+                sent = writev(out_fd, iov, (used > consecutive) ? 2 : 1);
+            }
+            else
+            {
+                sent = send(out_fd, first, consecutive, 0);
+            }
+            ++syscalls;
+            if (sent < 0)
+                throw_errno("send");
+
+            buf.move_read_pos(static_cast<std::size_t>(sent));
+        }
+    }
+
+    return syscalls;
+}
+
+template <IoMode Mode, typename Buffer>
+auto bench(std::size_t total_bytes) -> BenchResult
+{
+    int in_fds[2], out_fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, in_fds) || socketpair(AF_UNIX, SOCK_STREAM, 0, out_fds))
+        throw_errno("socketpair");
+
+    // producer: random sized chunks of a known byte pattern
+    std::jthread producer([&]() {
+        std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution<std::size_t> random_chunk(1, MAX_CHUNK_SIZE);
+        std::vector<std::uint8_t> chunk(MAX_CHUNK_SIZE);
+
+        for (std::size_t pos = 0; pos < total_bytes;)
+        {
+            const std::size_t length = std::min(random_chunk(rng), total_bytes - pos);
+            for (std::size_t i = 0; i < length; ++i)
+                chunk[i] = static_cast<std::uint8_t>(pos + i);
+            for (std::size_t sent = 0; sent < length;)
+            {
+                const ssize_t result = send(in_fds[0], chunk.data() + sent, length - sent, 0);
+                if (result < 0)
+                    throw_errno("producer send");
+                sent += static_cast<std::size_t>(result);
+            }
+            pos += length;
+        }
+    });
+
+    // consumer: verify the pattern
+    bool verified = true;
+    std::jthread consumer([&]() {
+        std::vector<std::uint8_t> chunk(MAX_CHUNK_SIZE);
+        for (std::size_t pos = 0; pos < total_bytes;)
+        {
+            const ssize_t result = recv(out_fds[1], chunk.data(), chunk.size(), 0);
+            if (result <= 0)
+            {
+                verified = false;
+                break;
+            }
+            for (ssize_t i = 0; i < result; ++i)
+                if (chunk[i] != static_cast<std::uint8_t>(pos + i))
+                    verified = false;
+            pos += static_cast<std::size_t>(result);
+        }
+    });
+
+    Buffer buf(RING_BUF_SIZE);
+
+    const auto started = Clock::now();
+    const std::uint64_t syscalls = relay<Mode>(buf, in_fds[1], out_fds[0], total_bytes);
+    producer.join();
+    consumer.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    for (const int fd : {in_fds[0], in_fds[1], out_fds[0], out_fds[1]})
+        close(fd);
+
+    return {syscalls, elapsed.count(), verified};
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t total_bytes = (argc == 2) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_TOTAL_BYTES;
+    if (0 == total_bytes)
+    {
+        std::cout << "Usage: 07_ring_buffer_io_bench [total bytes]" << std::endl;
+        return 1;
+    }
+
+    const double mib = total_bytes / (1024.0 * 1024.0);
+    std::cout << std::format("relaying {:.1f} MiB through a {} byte ring buffer\n", mib, RING_BUF_SIZE);
+    std::cout << std::format("{:>28} | {:>12} | {:>12} | {:>10}\n", "mode", "syscalls", "syscalls/MiB", "MiB/s");
+
+    bool all_is_well = true;
+
+    auto report = [&](const char* name, const BenchResult& result) {
+        std::cout << std::format("{:>28} | {:>12} | {:>12.1f} | {:>10.1f}\n", name, result.syscalls,
+                                 result.syscalls / mib, mib / result.seconds);
+        all_is_well = all_is_well && result.verified;
+    };
+
+    report("RingByteBuffer recv/send", bench<IoMode::SPLIT, nb::RingByteBuffer<>>(total_bytes));
+    report("RingByteBuffer readv/writev", bench<IoMode::VECTORED, nb::RingByteBuffer<>>(total_bytes));
+    report("MirroredRingBuffer recv/send", bench<IoMode::MIRRORED, vtp::MirroredRingBuffer>(total_bytes));
+
+    if (!all_is_well)
+        std::cout << "payload verification failed!" << std::endl;
+    return !all_is_well;
+}
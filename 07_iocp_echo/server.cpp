@@ -1,143 +1,587 @@
+#include "BufferPool.hpp"
+#include "SessionBuffer.hpp"
+#include "SessionTable.hpp"
+#include "TimerWheel.hpp"
 #include "common.hpp"
 
-#include <DirtySocks/ErrorCodes.hpp>
 #include <DirtySocks/System.hpp>
 #include <DirtySocks/TcpListener.hpp>
-#include <DirtySocks/TcpSocket.hpp>
-#include <NetBuff/RingByteBuffer.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <optional>
+#include <span>
 #include <thread>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <WinSock2.h>
+#include <MSWSock.h>
 #include <Windows.h>
+#include <Psapi.h>
 #include <process.h>
 
+using Clock = TimerWheel::Clock;
+
 static constexpr std::uint16_t PORT = 32983;
 
-static constexpr std::size_t RING_BUF_SIZE = 2048;
+// 100k idle connections fit; the slot array (`sizeof(Session)` each) is allocated up front
+static constexpr std::uint32_t MAX_SESSIONS = 128 * 1024;
 
-struct Session
+// 끊긴 세션이 이만큼 쌓이면 워커가 회수
+static constexpr std::uint32_t RECLAIM_BATCH = 64;
+
+static constexpr ULONG DEFAULT_DEQUEUE_BATCH = 64;
+
+// `AcceptEx()` kept in flight on the listener
+static constexpr std::size_t PENDING_ACCEPTS = 64;
+
+// completion key of the listener; never a session id, whose generation is odd
+static constexpr ULONG_PTR LISTENER_KEY = 0;
+
+// `AcceptEx()` wants 16 bytes more than the address
+static constexpr DWORD ACCEPT_ADDRESS_SIZE = sizeof(sockaddr_in) + 16;
+
+// nothing received for this long, with no send in flight
+static constexpr auto IDLE_TIMEOUT = std::chrono::seconds(60);
+
+// a send in flight for this long means the peer stopped reading
+static constexpr auto WRITE_STALL_TIMEOUT = std::chrono::seconds(10);
+
+// 완료 통계를 출력하는 주기
+static constexpr auto STATS_INTERVAL = std::chrono::seconds(5);
+
+enum class IoOp
 {
-    using Id = int;
+    RECEIVE,
+    SEND,
+};
 
-    Id id;
-    ds::TcpSocket sock;
-    nb::RingByteBuffer<> buf;
+/// One direction of a session's I/O; the completed `OVERLAPPED` tells the worker which one it was.
+struct IoContext
+{
     WSAOVERLAPPED overlapped;
-    bool sending;
+    const IoOp op;
 
-    Session(Session::Id id_, ds::TcpSocket&& sock_)
-        : id(id_), sock(std::move(sock_)), buf(RING_BUF_SIZE), overlapped{}, sending(false)
+    explicit IoContext(IoOp op_) : overlapped{}, op(op_)
     {
     }
 };
 
-struct SessionMap
+/// Keeps a receive and a send in flight at the same time, so that a pipelining client never waits
+/// for the server to drain its echoes before it's read from again.
+///
+/// Holds a pooled buffer only while there's data to echo: an idle session waits with a zero-byte receive,
+/// takes a buffer once that completes (the socket is readable), and gives it back once everything is sent.
+///
+/// Lives in `g_sessions`, which counts its references: one per posted I/O, held until its completion is handled
+/// (plus the accepting worker's, until the first receive is posted). Dropping the last one closes the socket,
+/// and the session is destroyed later, in a batch.
+///
+/// Completions stamp its activity on any worker; the timer wheel of the worker that accepted it looks at the stamps
+/// now and then, and disconnects it once it's been idle, or stuck on a send, for too long.
+struct Session
 {
-    std::unordered_map<Session::Id, Session> map;
-    SRWLOCK lock;
+    using Id = SessionId;
+
+    Id id;
+    SOCKET sock; // created for `AcceptEx()`, so owned here rather than by a `ds::TcpSocket`
+    DuplexSessionBuffer buf;
+
+    IoContext recv_ctx;
+    IoContext send_ctx;
+
+    std::atomic<bool> sending;     // a send is in flight
+    std::atomic<bool> recv_paused; // buffer was full, so no receive is in flight until a send frees some space
+    std::atomic<bool> closing;     // disconnecting, post nothing more
 
-    SessionMap()
+    // `Clock` ticks since its epoch
+    std::atomic<Clock::rep> last_received;
+    std::atomic<Clock::rep> send_posted; // of the send in flight, `0` if none
+
+    // attaching and detaching `buf`
+    SRWLOCK buf_lock;
+    bool recv_active; // receive side uses `buf`, from a zero-byte receive completion until the next one is posted
+
+    // receive side only
+    bool recv_zero_byte;     // the receive in flight is a zero-byte one
+    std::size_t size_class;  // of the buffer to attach next, grows while the peer fills it up
+    std::size_t recv_posted; // room offered to the real receive in flight
+
+    Session(Session::Id id_, SOCKET sock_)
+        : id(id_), sock(sock_), recv_ctx(IoOp::RECEIVE), send_ctx(IoOp::SEND), sending(false), recv_paused(false),
+          closing(false), last_received(Clock::now().time_since_epoch().count()), send_posted(0),
+          buf_lock(SRWLOCK_INIT), recv_active(false), recv_zero_byte(false), size_class(0), recv_posted(0)
     {
-        InitializeSRWLock(&lock);
     }
+
+    ~Session()
+    {
+        if (INVALID_SOCKET != sock)
+            closesocket(sock);
+    }
+};
+
+/// One `AcceptEx()` in flight, and the socket it accepts into.
+struct AcceptContext
+{
+    WSAOVERLAPPED overlapped{};
+    SOCKET sock = INVALID_SOCKET;
+    char addresses[2 * ACCEPT_ADDRESS_SIZE]; // local and remote, written by `AcceptEx()`
 };
 
-SessionMap g_sessions;
+// completion key of each session socket is its id
+SessionTable<Session> g_sessions(MAX_SESSIONS);
 
 HANDLE g_iocp;
 
-unsigned __stdcall worker(void* arg)
+SOCKET g_listener;
+LPFN_ACCEPTEX g_accept_ex;
+AcceptContext g_accepts[PENDING_ACCEPTS];
+
+// completions each worker takes per `GetQueuedCompletionStatusEx()`
+ULONG g_dequeue_batch = DEFAULT_DEQUEUE_BATCH;
+
+std::atomic<std::uint64_t> g_dequeues;    // `GetQueuedCompletionStatusEx()` calls that returned completions
+std::atomic<std::uint64_t> g_completions; // completions they returned
+
+std::atomic<std::uint32_t> g_open_sessions; // from `emplace()` until the last reference is dropped
+
+std::atomic<std::uint64_t> g_idle_timeouts;
+std::atomic<std::uint64_t> g_stall_timeouts;
+
+/// No segments makes one empty `WSABUF`, for a zero-byte receive.
+auto to_wsa_bufs(const IoSegments& segments, WSABUF (&wsa_bufs)[2]) -> std::span<WSABUF>
 {
-    HANDLE iocp = (HANDLE)arg;
+    if (segments.empty())
+    {
+        wsa_bufs[0] = {0, nullptr};
+        return std::span(wsa_bufs, 1);
+    }
 
-    std::error_code ec;
+    for (std::size_t i = 0; i < segments.count; ++i)
+    {
+        wsa_bufs[i].buf = reinterpret_cast<char*>(segments.parts[i].data());
+        wsa_bufs[i].len = static_cast<ULONG>(segments.parts[i].size());
+    }
+    return std::span(wsa_bufs, segments.count);
+}
 
-    while (true)
+/// Stops posting I/O, and cancels what's in flight so that its completion comes back right away.
+void disconnect(Session& session)
+{
+    if (!session.closing.exchange(true))
+        CancelIoEx((HANDLE)session.sock, nullptr);
+}
+
+/// Drops a reference to `session`; the last one closes its socket, and retires it.
+void release_io(Session& session)
+{
+    const Session::Id id = session.id;
+    if (!g_sessions.release(id))
+        return;
+
+    // 게시된 I/O 가 하나도 없는 건 끊는 중일 때뿐 (수신이 멈췄으면 송신이 진행 중)
+    assert(session.closing);
+
+    // 이제 아무도 이 소켓으로 I/O 를 걸 수 없으니, 회수를 기다리지 않고 바로 닫음
+    closesocket(std::exchange(session.sock, INVALID_SOCKET));
+    g_sessions.retire(id);
+    g_open_sessions.fetch_sub(1, std::memory_order_relaxed);
+
+    if (g_sessions.retired_count() >= RECLAIM_BATCH)
+        g_sessions.reclaim();
+}
+
+void post_io(Session& session, IoContext& ctx, const IoSegments& segments)
+{
+    if (session.closing)
+        return;
+
+    g_sessions.add_ref(session.id);
+    ctx.overlapped = {};
+
+    WSABUF wsa_bufs[2];
+    const std::span<WSABUF> bufs = to_wsa_bufs(segments, wsa_bufs);
+    DWORD flags = 0;
+    const int result = (IoOp::SEND == ctx.op)
+                           ? WSASend(session.sock, bufs.data(), static_cast<DWORD>(bufs.size()), nullptr, 0,
+                                     &ctx.overlapped, nullptr)
+                           : WSARecv(session.sock, bufs.data(), static_cast<DWORD>(bufs.size()), nullptr, &flags,
+                                     &ctx.overlapped, nullptr);
+
+    // failed right away: no completion will come
+    if (SOCKET_ERROR == result && WSA_IO_PENDING != WSAGetLastError())
     {
-        // wait for async io
-        DWORD transferred = 0;
-        Session* session = nullptr;
-        OVERLAPPED* overlapped = nullptr;
-        const bool success = GetQueuedCompletionStatus(iocp, &transferred, (PULONG_PTR)&session, &overlapped, INFINITE);
+        disconnect(session);
+        release_io(session);
+    }
+}
 
-        // quit
-        if (success && !overlapped)
-            break;
+/// Sends the received bytes, unless a send is already in flight (its completion sends the rest).
+void try_send(Session& session)
+{
+    while (!session.buf.filled_segments().empty() && !session.sending.exchange(true))
+    {
+        // 플래그를 잡은 사이에 다른 송신 완료가 다 보냈을 수 있으니 다시 확인
+        if (const IoSegments filled = session.buf.filled_segments(); !filled.empty())
+        {
+            session.send_posted.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            post_io(session, session.send_ctx, filled);
+            return;
+        }
+        session.sending.store(false);
+    }
+}
+
+/// Gives `buf` back to the pool, if neither side uses it and it holds nothing; under `buf_lock`.
+void detach_if_idle(Session& session)
+{
+    if (session.buf.attached() && !session.recv_active && !session.sending && session.buf.empty())
+        session.buf.detach();
+}
 
-        // disconnect session
-        if (!success || !overlapped || 0 == transferred)
+/// Waits for the socket to be readable with a zero-byte receive, letting go of the buffer meanwhile.
+void post_wait(Session& session)
+{
+    AcquireSRWLockExclusive(&session.buf_lock);
+    session.recv_active = false;
+    detach_if_idle(session);
+    ReleaseSRWLockExclusive(&session.buf_lock);
+
+    session.recv_zero_byte = true;
+    post_io(session, session.recv_ctx, IoSegments{});
+}
+
+/// Posts the next receive, or pauses receiving while the buffer is full (`on_sent()` resumes it).
+void post_receive(Session& session)
+{
+    for (;;)
+    {
+        if (const IoSegments free = session.buf.free_segments(); !free.empty())
         {
-            if (overlapped)
-            {
-                AcquireSRWLockExclusive(&g_sessions.lock);
-                const auto erased = g_sessions.map.erase(session->id);
-                ReleaseSRWLockExclusive(&g_sessions.lock);
-                assert(erased);
-            }
-            continue;
+            session.recv_posted = free.size();
+            post_io(session, session.recv_ctx, free);
+            return;
         }
 
-        // update ring buffer position
-        if (session->sending)
-            session->buf.move_read_pos(transferred);
-        else
-            session->buf.move_write_pos(transferred);
+        session.recv_paused.store(true);
+
+        // 멈추는 사이에 송신 완료가 자리를 비웠다면, 재개는 플래그를 되돌린 쪽이 맡음
+        if (session.buf.free_segments().empty() || !session.recv_paused.exchange(false))
+            return;
+    }
+}
+
+/// Readable: takes a buffer (a bigger one, if the last was filled up and is empty now), and receives for real.
+void on_readable(Session& session)
+{
+    session.last_received.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+    AcquireSRWLockExclusive(&session.buf_lock);
+    session.recv_active = true;
+    if (session.buf.attached() && session.buf.capacity() < BufferPool::size_of(session.size_class) &&
+        !session.sending && session.buf.empty())
+        session.buf.detach();
+    if (!session.buf.attached())
+        session.buf.attach(session.size_class);
+    ReleaseSRWLockExclusive(&session.buf_lock);
+
+    post_receive(session);
+}
+
+void on_received(Session& session, DWORD transferred)
+{
+    // 받을 자리를 다 채웠으면 대량 전송 중이니 다음엔 더 큰 버퍼, 1/4 도 못 채웠으면 더 작은 버퍼
+    if (transferred == session.recv_posted)
+        session.size_class = std::min(session.size_class + 1, BufferPool::SIZE_CLASSES - 1);
+    else if (transferred < session.buf.capacity() / 4 && session.size_class > 0)
+        --session.size_class;
+
+    session.buf.commit_received(transferred);
+    try_send(session);
+
+    // 소켓에 더 남았다면 0 바이트 수신이 바로 완료됨
+    post_wait(session);
+}
+
+void on_sent(Session& session, DWORD transferred)
+{
+    session.buf.commit_sent(transferred);
+    session.send_posted.store(0, std::memory_order_relaxed);
+    session.sending.store(false);
+    try_send(session);
+
+    if (session.recv_paused.exchange(false))
+    {
+        post_receive(session);
+    }
+    else if (session.buf.empty())
+    {
+        AcquireSRWLockExclusive(&session.buf_lock);
+        detach_if_idle(session);
+        ReleaseSRWLockExclusive(&session.buf_lock);
+    }
+}
 
-        ds::IoBuffer io_buf[2];
-        const auto available_read = session->buf.used_space();
-        // if there's something to send
-        if (available_read > 0)
+/// Latest time to look at a session again, as it may start stalling anytime: a stall is noticed
+/// within twice its timeout.
+auto next_check(Clock::time_point now) -> Clock::time_point
+{
+    return now + std::min<Clock::duration>(IDLE_TIMEOUT, WRITE_STALL_TIMEOUT);
+}
+
+/// Disconnects the session of `id` if it's been idle or stalled for too long, or tells when to check again.
+auto on_timer(SessionId id) -> std::optional<Clock::time_point>
+{
+    // 다른 워커의 완료가 세션을 끝낼 수 있으니, 참조를 잡고 봄
+    Session* const session = g_sessions.acquire(id);
+    if (!session)
+        return std::nullopt;
+
+    // 송신이 걸려있으면 상대가 안 읽는 중인지를, 아니면 상대가 조용한지를 봄
+    const Clock::rep send_posted = session->send_posted.load(std::memory_order_relaxed);
+    const Clock::time_point deadline =
+        send_posted ? Clock::time_point(Clock::duration(send_posted)) + WRITE_STALL_TIMEOUT
+                    : Clock::time_point(Clock::duration(session->last_received.load(std::memory_order_relaxed))) +
+                          IDLE_TIMEOUT;
+
+    std::optional<Clock::time_point> next;
+    if (const auto now = Clock::now(); now < deadline)
+    {
+        next = std::min(deadline, next_check(now));
+    }
+    else if (!session->closing)
+    {
+        (send_posted ? g_stall_timeouts : g_idle_timeouts).fetch_add(1, std::memory_order_relaxed);
+        disconnect(*session);
+    }
+
+    release_io(*session);
+    return next;
+}
+
+/// Sets up a socket accepted by `AcceptEx()` as a new session, and posts its first receive.
+/// Its timer goes to `timers`, of the accepting worker.
+void open_session(SOCKET sock, TimerWheel& timers)
+{
+    const int enable = true;
+    const int zero = 0;
+
+    // inherit the listener's properties, then no nagle, and direct i/o;
+    // failing here means the peer is already gone
+    if (SOCKET_ERROR == setsockopt(sock, SOL_SOCKET, SO_UPDATE_ACCEPT_CONTEXT, (const char*)&g_listener,
+                                   sizeof(g_listener)) ||
+        SOCKET_ERROR == setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&enable, sizeof(enable)) ||
+        SOCKET_ERROR == setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (const char*)&zero, sizeof(zero)))
+    {
+        closesocket(sock);
+        return;
+    }
+
+    // 끊긴 세션들의 자리를 먼저 돌려받음
+    g_sessions.reclaim();
+
+    Session* const new_session = g_sessions.emplace(sock);
+    if (!new_session)
+    {
+        std::cout << "session table full (" << MAX_SESSIONS << "), connection dropped" << std::endl;
+        closesocket(sock);
+        return;
+    }
+
+    auto& session = *new_session;
+    g_open_sessions.fetch_add(1, std::memory_order_relaxed);
+
+    // associate new session with iocp
+    if (nullptr == CreateIoCompletionPort((HANDLE)session.sock, g_iocp, (ULONG_PTR)session.id, 0))
+        check_ec(ds::System::get_last_error_code());
+
+    timers.schedule(session.id, next_check(Clock::now()));
+
+    // wait for the first bytes without a buffer, then drop this thread's reference from `emplace()`
+    post_wait(session);
+    release_io(session);
+}
+
+/// Posts `AcceptEx()` into a fresh socket; its completion comes to a worker like any other.
+void post_accept(AcceptContext& ctx)
+{
+    ctx.sock = WSASocketW(AF_INET, SOCK_STREAM, IPPROTO_TCP, nullptr, 0, WSA_FLAG_OVERLAPPED);
+    if (INVALID_SOCKET == ctx.sock)
+        check_ec(ds::System::get_last_error_code());
+
+    ctx.overlapped = {};
+    DWORD received = 0;
+    if (!g_accept_ex(g_listener, ctx.sock, ctx.addresses, 0, ACCEPT_ADDRESS_SIZE, ACCEPT_ADDRESS_SIZE, &received,
+                     &ctx.overlapped) &&
+        WSA_IO_PENDING != WSAGetLastError())
+        check_ec(ds::System::get_last_error_code());
+}
+
+void on_accepted(AcceptContext& ctx, bool success, TimerWheel& timers)
+{
+    const SOCKET sock = std::exchange(ctx.sock, INVALID_SOCKET);
+
+    // 세션을 준비하기 전에 다음 연결부터 받아둠
+    post_accept(ctx);
+
+    if (success)
+        open_session(sock, timers);
+    else
+        closesocket(sock);
+}
+
+void on_completion(const OVERLAPPED_ENTRY& entry)
+{
+    // 완료된 I/O 의 참조를 쥐고 있으니 세션은 살아있음 (세대가 다르면 버그)
+    Session* const session = g_sessions.find(static_cast<SessionId>(entry.lpCompletionKey));
+    if (!session)
+    {
+        assert(false && "completion of a released session");
+        return;
+    }
+
+    const IoContext& ctx = *CONTAINING_RECORD(entry.lpOverlapped, IoContext, overlapped);
+    const DWORD transferred = entry.dwNumberOfBytesTransferred;
+
+    // `Internal` of the completed `OVERLAPPED` is its NTSTATUS
+    const bool success = (0 == entry.lpOverlapped->Internal);
+
+    // a zero-byte receive completes with nothing, but for a real one it means the peer closed
+    const bool readable = (IoOp::RECEIVE == ctx.op && std::exchange(session->recv_zero_byte, false));
+
+    // disconnect session, once the other direction is done too
+    if (!success || (0 == transferred && !readable))
+        disconnect(*session);
+    else if (readable)
+        on_readable(*session);
+    else if (IoOp::RECEIVE == ctx.op)
+        on_received(*session, transferred);
+    else
+        on_sent(*session, transferred);
+
+    release_io(*session);
+}
+
+unsigned __stdcall worker(void* arg)
+{
+    HANDLE iocp = (HANDLE)arg;
+    std::vector<OVERLAPPED_ENTRY> entries(g_dequeue_batch);
+
+    // timers of the sessions this worker accepted; only this thread touches it
+    TimerWheel timers(Clock::now());
+
+    for (bool quit = false; !quit;)
+    {
+        // wait for async io, taking every completion ready (up to a batch) in one call,
+        // or until the next tick of the timer wheel
+        const std::optional<Clock::duration> wait = timers.until_next_tick(Clock::now());
+        const DWORD wait_ms =
+            wait ? static_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(*wait).count()) : INFINITE;
+
+        ULONG count = 0;
+        if (!GetQueuedCompletionStatusEx(iocp, entries.data(), static_cast<ULONG>(entries.size()), &count, wait_ms,
+                                         false))
         {
-            session->sending = true;
-
-            // async send request
-            const auto consecutive_read = session->buf.consecutive_read_length();
-            const std::size_t io_buf_count = (available_read > consecutive_read ? 2 : 1);
-            io_buf[0].buf = reinterpret_cast<char*>(session->buf.data() + session->buf.read_pos());
-            io_buf[0].len = static_cast<unsigned>(consecutive_read);
-            if (2 == io_buf_count)
-            {
-                io_buf[1].buf = reinterpret_cast<char*>(session->buf.data());
-                io_buf[1].len = static_cast<unsigned>(available_read - consecutive_read);
-            }
-            session->sock.send(std::span(io_buf).subspan(0, io_buf_count), session->overlapped, ec);
-            if (ec != ds::SystemErrc::io_pending)
-                check_ec(ec);
+            // 타임아웃이면 타이머만 돌림
+            if (WAIT_TIMEOUT != GetLastError())
+                continue;
+            count = 0;
         }
-        else // nothing to send
+        else
         {
-            session->sending = false;
-
-            // async receive request
-            const auto consecutive_write = session->buf.consecutive_write_length();
-            const auto available_write = session->buf.available_space();
-            const std::size_t io_buf_count = (available_write > consecutive_write ? 2 : 1);
-            io_buf[0].buf = reinterpret_cast<char*>(session->buf.data() + session->buf.write_pos());
-            io_buf[0].len = static_cast<unsigned>(consecutive_write);
-            if (2 == io_buf_count)
+            g_dequeues.fetch_add(1, std::memory_order_relaxed);
+            g_completions.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        for (const OVERLAPPED_ENTRY& entry : std::span(entries.data(), count))
+        {
+            // quit, after the rest of this batch; one quit per worker, so pass on any extra
+            if (!entry.lpOverlapped)
             {
-                io_buf[1].buf = reinterpret_cast<char*>(session->buf.data());
-                io_buf[1].len = static_cast<unsigned>(available_write - consecutive_write);
+                if (quit)
+                    PostQueuedCompletionStatus(iocp, 0, 0, nullptr);
+                quit = true;
+                continue;
             }
-            session->sock.receive(std::span(io_buf).subspan(0, io_buf_count), session->overlapped, ec);
-            if (ec != ds::SystemErrc::io_pending)
-                check_ec(ec);
+
+            if (LISTENER_KEY == entry.lpCompletionKey)
+                on_accepted(*CONTAINING_RECORD(entry.lpOverlapped, AcceptContext, overlapped),
+                            0 == entry.lpOverlapped->Internal, timers);
+            else
+                on_completion(entry);
         }
+
+        timers.advance(Clock::now(), on_timer);
     }
 
     return 0;
 }
 
-int main()
+/// Prints completions per dequeue now and then, while there's traffic, and the sessions timed out meanwhile;
+/// and the memory footprint, whenever the number of open sessions changed.
+void report_stats()
 {
+    std::uint64_t last_dequeues = 0, last_completions = 0, last_idle_timeouts = 0, last_stall_timeouts = 0;
+    std::uint32_t last_open_sessions = 0;
+    while (true)
+    {
+        std::this_thread::sleep_for(STATS_INTERVAL);
+
+        const std::uint64_t dequeues = g_dequeues.load(std::memory_order_relaxed);
+        const std::uint64_t completions = g_completions.load(std::memory_order_relaxed);
+        if (dequeues != last_dequeues)
+        {
+            const std::uint64_t calls = dequeues - last_dequeues;
+            const std::uint64_t reaped = completions - last_completions;
+            std::cout << reaped << " completions in " << calls << " dequeues ("
+                      << static_cast<double>(reaped) / calls << " per call)\n";
+        }
+        last_dequeues = dequeues;
+        last_completions = completions;
+
+        const std::uint64_t idle_timeouts = g_idle_timeouts.load(std::memory_order_relaxed);
+        const std::uint64_t stall_timeouts = g_stall_timeouts.load(std::memory_order_relaxed);
+        if (idle_timeouts != last_idle_timeouts || stall_timeouts != last_stall_timeouts)
+        {
+            std::cout << idle_timeouts - last_idle_timeouts << " sessions timed out idle, "
+                      << stall_timeouts - last_stall_timeouts << " stalled on sending\n";
+        }
+        last_idle_timeouts = idle_timeouts;
+        last_stall_timeouts = stall_timeouts;
+
+        // 유휴 세션 하나당 드는 메모리는 (작업 집합 - 세션 없을 때) / 세션 수로 봄
+        const std::uint32_t open_sessions = g_open_sessions.load(std::memory_order_relaxed);
+        PROCESS_MEMORY_COUNTERS memory{};
+        if (open_sessions != last_open_sessions && GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+        {
+            std::cout << open_sessions << " sessions open, " << memory.WorkingSetSize / (1024 * 1024)
+                      << " MiB working set, " << memory.PagefileUsage / (1024 * 1024) << " MiB committed, "
+                      << BufferPool::instance().reserved_bytes() / 1024 << " KiB of pooled buffers\n";
+        }
+        last_open_sessions = open_sessions;
+    }
+}
+
+/// Usage: 07_iocp_echo_server [<dequeue batch>]
+int main(int argc, char** argv)
+{
+    if (argc > 2 || (2 == argc && std::atoi(argv[1]) <= 0))
+    {
+        std::cout << "Usage: 07_iocp_echo_server [<dequeue batch>]" << std::endl;
+        return 1;
+    }
+    if (2 == argc)
+        g_dequeue_batch = static_cast<ULONG>(std::atoi(argv[1]));
+
     std::error_code ec;
 
     ds::System::init(ec);
@@ -145,7 +589,8 @@ int main()
 
     const unsigned cores = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
     const unsigned workers_count = cores * 2;
-    std::cout << "assuming " << cores << " cores (" << workers_count << " workers)\n";
+    std::cout << "assuming " << cores << " cores (" << workers_count << " workers, dequeuing up to "
+              << g_dequeue_batch << " completions at once)\n";
 
     // prepare iocp
     g_iocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 0);
@@ -170,57 +615,31 @@ int main()
     ds::TcpListener listener;
     listener.listen(ds::SocketAddress::any(PORT, ds::IpVersion::V4), ec);
     check_ec(ec);
+    g_listener = listener.get_handle();
 
     // reuse addr
     const int enable = true;
-    if (SOCKET_ERROR ==
-        setsockopt(listener.get_handle(), SOL_SOCKET, SO_REUSEADDR, (const char*)&enable, sizeof(enable)))
+    if (SOCKET_ERROR == setsockopt(g_listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&enable, sizeof(enable)))
         check_ec(ds::System::get_last_error_code());
 
-    Session::Id next_session_id = 0;
-
-    // accept new session
-    while (true)
-    {
-        ds::TcpSocket sock;
-        listener.accept(sock, ec);
-        check_ec(ec);
-
-        sock.set_non_blocking(true, ec);
-        check_ec(ec);
-
-        // no nagle
-        if (SOCKET_ERROR ==
-            setsockopt(sock.get_handle(), IPPROTO_TCP, TCP_NODELAY, (const char*)&enable, sizeof(enable)))
-            check_ec(ec);
-
-        // direct i/o
-        const int zero = 0;
-        if (SOCKET_ERROR == setsockopt(sock.get_handle(), SOL_SOCKET, SO_SNDBUF, (const char*)&zero, sizeof(zero)))
-            check_ec(ds::System::get_last_error_code());
+    // accept on the workers: associate the listener with iocp, and keep `AcceptEx()` in flight on it
+    if (nullptr == CreateIoCompletionPort((HANDLE)g_listener, g_iocp, LISTENER_KEY, 0))
+        check_ec(ds::System::get_last_error_code());
 
-        AcquireSRWLockExclusive(&g_sessions.lock);
-        auto [it, inserted] = g_sessions.map.try_emplace(next_session_id, next_session_id, std::move(sock));
-        ReleaseSRWLockExclusive(&g_sessions.lock);
-        assert(inserted);
-        ++next_session_id;
+    GUID accept_ex_id = WSAID_ACCEPTEX;
+    DWORD bytes = 0;
+    if (SOCKET_ERROR == WSAIoctl(g_listener, SIO_GET_EXTENSION_FUNCTION_POINTER, &accept_ex_id, sizeof(accept_ex_id),
+                                 &g_accept_ex, sizeof(g_accept_ex), &bytes, nullptr, nullptr))
+        check_ec(ds::System::get_last_error_code());
 
-        auto& session = it->second;
+    for (AcceptContext& ctx : g_accepts)
+        post_accept(ctx);
 
-        // associate new session with iocp
-        auto iocp = CreateIoCompletionPort((HANDLE)session.sock.get_handle(), g_iocp, (ULONG_PTR)&session, 0);
-        if (nullptr == iocp)
-            check_ec(ds::System::get_last_error_code());
-
-        // async receive request
-        ds::IoBuffer io_buf[1];
-        io_buf[0].buf = reinterpret_cast<char*>(session.buf.data() + session.buf.write_pos());
-        io_buf[0].len = static_cast<unsigned>(session.buf.available_space());
-        session.sock.receive(io_buf, session.overlapped, ec);
-    }
+    // nothing left for this thread but reporting
+    report_stats();
 
     // wait for worker threads to close
-    for (std::size_t i = 0; workers.size(); ++i)
+    for (std::size_t i = 0; i < workers.size(); ++i)
         PostQueuedCompletionStatus(g_iocp, 0, 0, nullptr);
     WaitForMultipleObjects(static_cast<DWORD>(workers.size()), workers.data(), true, INFINITE);
     for (HANDLE worker : workers)
@@ -228,9 +647,5 @@ int main()
 
     CloseHandle(g_iocp);
 
-    AcquireSRWLockExclusive(&g_sessions.lock);
-    g_sessions.map.clear();
-    ReleaseSRWLockExclusive(&g_sessions.lock);
-
     ds::System::destroy();
 }
@@ -0,0 +1,282 @@
+#include "SessionTable.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::uint32_t CAPACITY = 16384;
+static constexpr int DEFAULT_THREADS = 4;
+static constexpr int DEFAULT_ROUNDS = 200'000;
+
+// 세션 하나가 살아있는 동안 받는 완료 수 흉내
+static constexpr int FINDS_PER_SESSION = 8;
+
+// 워커가 모아서 회수하는 끊긴 세션 수
+static constexpr std::uint32_t RECLAIM_BATCH = 64;
+
+static constexpr double STRESS_SECONDS = 1.0;
+static constexpr std::size_t PUBLISHED_IDS = 64;
+static constexpr std::size_t HELD_PER_OWNER = 16;
+
+static constexpr std::uint32_t ALIVE = 0xA11FE;
+static constexpr std::uint32_t DEAD = 0xDEAD;
+
+struct FakeSession
+{
+    SessionId id;
+    int owner;           // thread that created it, to catch two threads sharing a slot
+    std::uint32_t magic; // `DEAD` once destroyed, to catch a use after free
+
+    FakeSession(SessionId id_, int owner_) : id(id_), owner(owner_), magic(ALIVE)
+    {
+    }
+
+    ~FakeSession()
+    {
+        magic = DEAD;
+    }
+};
+
+/// The previous session map: `unordered_map` behind one lock, taken on every insert, lookup and erase.
+class LockedSessionMap
+{
+public:
+    auto emplace(int owner) -> FakeSession*
+    {
+        std::lock_guard guard(_lock);
+        const SessionId id = _next_id++;
+        return &_map.try_emplace(id, id, owner).first->second;
+    }
+
+    auto find(SessionId id) -> FakeSession*
+    {
+        std::lock_guard guard(_lock);
+        const auto it = _map.find(id);
+        return (it == _map.end()) ? nullptr : &it->second;
+    }
+
+    /// Erases it right away: the map isn't reference-counted, so the only reference is the creator's.
+    bool release(SessionId id)
+    {
+        std::lock_guard guard(_lock);
+        return _map.erase(id);
+    }
+
+    // nothing deferred
+    void retire(SessionId)
+    {
+    }
+    auto retired_count() const -> std::uint32_t
+    {
+        return 0;
+    }
+    auto reclaim() -> std::uint32_t
+    {
+        return 0;
+    }
+
+private:
+    std::mutex _lock;
+    std::unordered_map<SessionId, FakeSession> _map;
+    SessionId _next_id = 0;
+};
+
+struct BenchResult
+{
+    double seconds;
+    bool verified;
+};
+
+/// Every thread churns sessions: create one, look it up a few times as its completions would, then drop it.
+/// An old id must never be found again.
+template <typename Table>
+auto bench(Table& table, int threads, int rounds) -> BenchResult
+{
+    std::atomic<bool> verified = true;
+
+    const auto started = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                for (int round = 0; round < rounds; ++round)
+                {
+                    FakeSession* const session = table.emplace(t);
+                    if (!session)
+                    {
+                        verified = false;
+                        return;
+                    }
+
+                    const SessionId id = session->id;
+                    for (int i = 0; i < FINDS_PER_SESSION; ++i)
+                    {
+                        const FakeSession* const found = table.find(id);
+                        if (found != session || found->owner != t)
+                            verified = false;
+                    }
+
+                    if (!table.release(id) || table.find(id))
+                        verified = false;
+
+                    table.retire(id);
+                    if (table.retired_count() >= RECLAIM_BATCH)
+                        table.reclaim();
+                }
+            });
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    return {elapsed.count(), verified};
+}
+
+struct StressResult
+{
+    std::uint64_t created;
+    std::uint64_t acquired; // references taken through a published id
+    std::uint64_t rejected; // stale ids turned away
+    bool verified;
+};
+
+/// Owners churn sessions and publish their ids, while the other threads grab random published ids and
+/// `acquire()` them, as a late completion or a broadcast would, racing the owners' `release()`.
+/// A session must never be handed out once its last reference is gone, nor destroyed while referenced.
+auto stress(int threads, double seconds) -> StressResult
+{
+    SessionTable<FakeSession> table(CAPACITY);
+    std::atomic<SessionId> published[PUBLISHED_IDS] = {};
+    std::atomic<bool> stop = false;
+
+    std::atomic<std::uint64_t> created = 0, acquired = 0, rejected = 0;
+    std::atomic<bool> verified = true;
+
+    // 마지막 참조를 놓은 쪽이 누구든 그 스레드가 회수 대기열에 넣음
+    auto drop = [&](SessionId id) {
+        if (!table.release(id))
+            return;
+        if (table.find(id) || table.acquire(id))
+            verified = false;
+        table.retire(id);
+        if (table.retired_count() >= RECLAIM_BATCH)
+            table.reclaim();
+    };
+
+    // 세션을 몇 개씩 살려둬야 읽는 쪽이 살아있는 id 도 잡음
+    auto owner = [&](int t) {
+        SessionId held[HELD_PER_OWNER] = {};
+        std::uint64_t count = 0;
+        for (std::size_t i = t; !stop.load(std::memory_order_relaxed); i = (i + 1) % PUBLISHED_IDS)
+        {
+            FakeSession* const session = table.emplace(t);
+            if (!session)
+                continue; // 회수 전이라 가득 찰 수 있음
+
+            published[i].store(session->id);
+            SessionId& oldest = held[count++ % HELD_PER_OWNER];
+            if (oldest)
+                drop(oldest);
+            oldest = session->id;
+        }
+        for (const SessionId id : held)
+        {
+            if (id)
+                drop(id);
+        }
+        created += count;
+    };
+
+    auto reader = [&](int t) {
+        std::uint64_t ok = 0, stale = 0;
+        for (std::size_t i = t; !stop.load(std::memory_order_relaxed); i = (i * 7 + 1) % PUBLISHED_IDS)
+        {
+            const SessionId id = published[i].load();
+            FakeSession* const session = table.acquire(id);
+            if (!session)
+            {
+                ++stale;
+                continue;
+            }
+
+            if (session->magic != ALIVE || session->id != id)
+                verified = false;
+            ++ok;
+            drop(id);
+        }
+        acquired += ok;
+        rejected += stale;
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            if (t % 2)
+                workers.emplace_back(reader, t);
+            else
+                workers.emplace_back(owner, t);
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+    }
+
+    table.reclaim();
+    return {created, acquired, rejected, verified};
+}
+
+int main(int argc, char** argv)
+{
+    const int threads = (argc >= 2) ? std::atoi(argv[1]) : DEFAULT_THREADS;
+    const int rounds = (argc >= 3) ? std::atoi(argv[2]) : DEFAULT_ROUNDS;
+    if (argc > 3 || threads <= 0 || rounds <= 0)
+    {
+        std::cout << "Usage: 07_session_table_bench [threads] [sessions per thread]" << std::endl;
+        return 1;
+    }
+
+    const double sessions = static_cast<double>(threads) * rounds;
+    std::cout << std::format("{} threads, {} sessions each, {} lookups per session\n", threads, rounds,
+                             FINDS_PER_SESSION);
+    std::cout << std::format("{:>20} | {:>14} | {:>12}\n", "table", "sessions/s", "ns/session");
+
+    bool all_is_well = true;
+
+    auto report = [&](const char* name, const BenchResult& result) {
+        std::cout << std::format("{:>20} | {:>14.0f} | {:>12.1f}\n", name, sessions / result.seconds,
+                                 result.seconds * 1e9 / sessions);
+        all_is_well = all_is_well && result.verified;
+    };
+
+    {
+        LockedSessionMap map;
+        report("locked unordered_map", bench(map, threads, rounds));
+    }
+    {
+        SessionTable<FakeSession> table(CAPACITY);
+        report("SessionTable", bench(table, threads, rounds));
+    }
+
+    {
+        const StressResult result = stress(std::max(threads, 2), STRESS_SECONDS);
+        std::cout << std::format("acquire/release stress: {} sessions, {} acquired, {} stale ids rejected\n",
+                                 result.created, result.acquired, result.rejected);
+        all_is_well = all_is_well && result.verified && result.created > 0;
+    }
+
+    if (!all_is_well)
+        std::cout << "verification failed!" << std::endl;
+    return !all_is_well;
+}
@@ -0,0 +1,187 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using Clock = TimerWheel::Clock;
+using namespace std::chrono_literals;
+
+static constexpr std::uint32_t DEFAULT_SESSIONS = 100'000;
+
+// 시뮬레이션 시간: 100ms 틱으로 60초
+static constexpr auto TICK = TimerWheel::DEFAULT_TICK;
+static constexpr int STEPS = 600;
+static constexpr auto IDLE_TIMEOUT = 5s;
+
+// 매 틱마다 세션의 20% 에 완료가 옴 (틱 경계에서 어긋난 시각에)
+static constexpr int TOUCHES_PER_MILLE = 200;
+static constexpr auto TOUCH_OFFSET = 37ms;
+
+// every `SILENT_EVERY`th session goes silent for good from step `SILENT_FROM`
+static constexpr std::uint32_t SILENT_EVERY = 10;
+static constexpr int SILENT_FROM = 100;
+
+/// Expired `(step, key)`s, in the order they expired.
+using Expirations = std::vector<std::pair<int, std::uint32_t>>;
+
+struct BenchResult
+{
+    double seconds;
+    std::uint64_t touches;
+    Expirations expired;
+};
+
+/// Completions of each step, the same for every timer kind.
+auto make_touches(std::uint32_t sessions) -> std::vector<std::vector<std::uint32_t>>
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::uint32_t> pick(0, sessions - 1);
+    const std::uint32_t count = std::max<std::uint32_t>(1, sessions * TOUCHES_PER_MILLE / 1000);
+
+    std::vector<std::vector<std::uint32_t>> touches(STEPS);
+    for (int step = 0; step < STEPS; ++step)
+    {
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            const std::uint32_t key = pick(rng);
+            if (step < SILENT_FROM || 0 != key % SILENT_EVERY)
+                touches[step].push_back(key);
+        }
+    }
+    return touches;
+}
+
+/// Every completion stamps the time only; `TimerWheel` looks at the stamps when a timer expires.
+auto bench_wheel(std::uint32_t sessions, const std::vector<std::vector<std::uint32_t>>& touches) -> BenchResult
+{
+    const Clock::time_point origin = Clock::now();
+    TimerWheel timers(origin, TICK);
+    std::vector<Clock::time_point> last_active(sessions, origin);
+    std::vector<bool> closed(sessions);
+    for (std::uint32_t key = 0; key < sessions; ++key)
+        timers.schedule(key, origin + IDLE_TIMEOUT);
+
+    BenchResult result{};
+    const auto started = Clock::now();
+    for (int step = 0; step < STEPS; ++step)
+    {
+        const Clock::time_point now = origin + step * TICK + TOUCH_OFFSET;
+        for (const std::uint32_t key : touches[step])
+        {
+            if (!closed[key])
+            {
+                last_active[key] = now;
+                ++result.touches;
+            }
+        }
+
+        const Clock::time_point due = origin + step * TICK;
+        timers.advance(now, [&](TimerWheel::Key key) -> std::optional<Clock::time_point> {
+            const Clock::time_point deadline = last_active[key] + IDLE_TIMEOUT;
+            if (deadline > due)
+                return deadline;
+
+            closed[key] = true;
+            result.expired.emplace_back(step, static_cast<std::uint32_t>(key));
+            return std::nullopt;
+        });
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    result.seconds = elapsed.count();
+    return result;
+}
+
+/// Every completion moves the session's deadline in an ordered set, which is what a timer queue without
+/// lazy re-scheduling has to do.
+auto bench_ordered_set(std::uint32_t sessions, const std::vector<std::vector<std::uint32_t>>& touches) -> BenchResult
+{
+    const Clock::time_point origin = Clock::now();
+    std::set<std::pair<Clock::time_point, std::uint32_t>> timers;
+    std::vector<Clock::time_point> deadlines(sessions, origin + IDLE_TIMEOUT);
+    std::vector<bool> closed(sessions);
+    for (std::uint32_t key = 0; key < sessions; ++key)
+        timers.emplace(deadlines[key], key);
+
+    BenchResult result{};
+    const auto started = Clock::now();
+    for (int step = 0; step < STEPS; ++step)
+    {
+        const Clock::time_point now = origin + step * TICK + TOUCH_OFFSET;
+        for (const std::uint32_t key : touches[step])
+        {
+            if (!closed[key])
+            {
+                timers.erase({deadlines[key], key});
+                deadlines[key] = now + IDLE_TIMEOUT;
+                timers.emplace(deadlines[key], key);
+                ++result.touches;
+            }
+        }
+
+        // 휠과 같은 단위로: 이번 틱 경계까지 지난 것만
+        const Clock::time_point due = origin + step * TICK;
+        while (!timers.empty() && timers.begin()->first <= due)
+        {
+            const std::uint32_t key = timers.begin()->second;
+            timers.erase(timers.begin());
+            closed[key] = true;
+            result.expired.emplace_back(step, key);
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    result.seconds = elapsed.count();
+    return result;
+}
+
+/// Usage: 07_timer_wheel_bench [sessions]
+int main(int argc, char** argv)
+{
+    const long sessions = (argc >= 2) ? std::atol(argv[1]) : DEFAULT_SESSIONS;
+    if (argc > 2 || sessions < static_cast<long>(SILENT_EVERY))
+    {
+        std::cout << "Usage: 07_timer_wheel_bench [sessions]" << std::endl;
+        return 1;
+    }
+
+    const auto count = static_cast<std::uint32_t>(sessions);
+    const auto touches = make_touches(count);
+
+    std::cout << std::format("{} sessions, {}s idle timeout, {} steps of {}ms, {}% of the sessions active per step\n",
+                             count, IDLE_TIMEOUT.count(), STEPS, TICK.count(), TOUCHES_PER_MILLE / 10.0);
+    std::cout << std::format("{:>12} | {:>14} | {:>12} | {:>10}\n", "timers", "touches/s", "ns/touch", "expired");
+
+    auto report = [&](const char* name, const BenchResult& result) {
+        std::cout << std::format("{:>12} | {:>14.0f} | {:>12.1f} | {:>10}\n", name, result.touches / result.seconds,
+                                 result.seconds * 1e9 / result.touches, result.expired.size());
+    };
+
+    BenchResult ordered = bench_ordered_set(count, touches);
+    report("ordered set", ordered);
+    BenchResult wheel = bench_wheel(count, touches);
+    report("timer wheel", wheel);
+
+    // 같은 세션들이 같은 틱에 만료되어야 하고, 조용해진 세션은 전부 만료되어야 함
+    std::sort(ordered.expired.begin(), ordered.expired.end());
+    std::sort(wheel.expired.begin(), wheel.expired.end());
+    std::uint32_t silent_expired = 0;
+    for (const auto& [step, key] : wheel.expired)
+        silent_expired += (0 == key % SILENT_EVERY);
+    const bool all_is_well = !wheel.expired.empty() && wheel.expired == ordered.expired &&
+                             silent_expired == (count + SILENT_EVERY - 1) / SILENT_EVERY;
+
+    if (!all_is_well)
+        std::cout << "verification failed!" << std::endl;
+    return !all_is_well;
+}
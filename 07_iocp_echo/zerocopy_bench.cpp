@@ -0,0 +1,255 @@
+#include "Framing.hpp"
+#include "SessionBuffer.hpp"
+#include "ZeroCopy.hpp"
+#include "linux_common.hpp"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t DEFAULT_TOTAL_BYTES = 1024 * 1024 * 1024;
+static constexpr std::size_t ZEROCOPY_RING_BUF_SIZE = 256 * 1024;
+static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+static constexpr double GIB = 1024.0 * 1024.0 * 1024.0;
+
+enum class SendMode
+{
+    COPY,
+    ZEROCOPY, // every send, even if the kernel reports it copied them
+};
+
+struct BenchResult
+{
+    double seconds;
+    double cpu_seconds; // of the relay thread
+    std::uint64_t zerocopy_sends;
+    std::uint64_t copied; // zero-copy sends the kernel copied after all
+    bool verified;
+};
+
+auto thread_cpu_seconds() -> double
+{
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/// Both ends of a loopback TCP connection: zero-copy isn't supported over Unix domain sockets.
+auto loopback_pair() -> std::pair<UniqueFd, UniqueFd>
+{
+    UniqueFd listener(socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (!listener || bind(listener.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ||
+        listen(listener.get(), 1) || getsockname(listener.get(), reinterpret_cast<sockaddr*>(&addr), &addr_len))
+        throw_errno("loopback listener");
+
+    UniqueFd client(socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (!client || connect(client.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)))
+        throw_errno("loopback connect");
+    UniqueFd server(accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC));
+    if (!server)
+        throw_errno("loopback accept");
+
+    return {std::move(client), std::move(server)};
+}
+
+/// Relays `total_bytes` from `in_fd` to `out_fd` through the ring buffer, in sends of up to `send_size` bytes,
+/// as `EpollWorker::echo()` does with `use_zerocopy()`: zero-copy sends keep their ring buffer space
+/// until the kernel's completion arrives.
+template <SendMode Mode>
+void relay(nb::RingByteBuffer<>& buf, int in_fd, int out_fd, std::size_t total_bytes, std::size_t send_size,
+           BenchResult& result)
+{
+    ZeroCopySends sends;
+    for (std::size_t released = 0; released < total_bytes;)
+    {
+        bool progress = false;
+
+        if (sends.pending())
+        {
+            const std::optional<ZeroCopySends::Reaped> reaped = sends.reap(out_fd);
+            if (!reaped)
+                throw_errno("error queue");
+            buf.move_read_pos(reaped->released);
+            released += reaped->released;
+            result.copied += reaped->copied;
+            progress = 0 != reaped->released;
+        }
+
+        const IoSegments filled = filled_segments(buf);
+        const IoSegments unsent =
+            slice(filled, sends.in_flight(), std::min(filled.size() - sends.in_flight(), send_size));
+        if (!unsent.empty())
+        {
+            iovec iov[2];
+            for (std::size_t i = 0; i < unsent.count; ++i)
+                iov[i] = {unsent.parts[i].data(), unsent.parts[i].size()};
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = unsent.count;
+
+            const bool zerocopy = (Mode == SendMode::ZEROCOPY);
+            const ssize_t sent = sendmsg(out_fd, &msg, MSG_DONTWAIT | (zerocopy ? MSG_ZEROCOPY : 0));
+            if (sent < 0 && EAGAIN != errno && ENOBUFS != errno)
+                throw_errno("sendmsg");
+            if (sent > 0)
+            {
+                const std::size_t release = sends.sent(static_cast<std::size_t>(sent), zerocopy);
+                buf.move_read_pos(release);
+                released += release;
+                result.zerocopy_sends += zerocopy ? 1 : 0;
+                progress = true;
+            }
+        }
+
+        if (const IoSegments free = free_segments(buf); !free.empty())
+        {
+            iovec iov[2];
+            for (std::size_t i = 0; i < free.count; ++i)
+                iov[i] = {free.parts[i].data(), free.parts[i].size()};
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = free.count;
+
+            const ssize_t received = recvmsg(in_fd, &msg, MSG_DONTWAIT);
+            if (received < 0 && EAGAIN != errno)
+                throw_errno("recvmsg");
+            if (received > 0)
+            {
+                buf.move_write_pos(static_cast<std::size_t>(received));
+                progress = true;
+            }
+        }
+
+        // 완료 알림은 POLLERR 로 옴 (항상 보고됨)
+        if (!progress)
+        {
+            pollfd fds[2] = {{in_fd, static_cast<short>(buf.available_space() ? POLLIN : 0), 0},
+                             {out_fd, static_cast<short>(filled.size() > sends.in_flight() ? POLLOUT : 0), 0}};
+            poll(fds, 2, -1);
+        }
+    }
+}
+
+template <SendMode Mode>
+auto bench(std::size_t total_bytes, std::size_t send_size) -> BenchResult
+{
+    auto [in_writer, in_reader] = loopback_pair();
+    auto [out_writer, out_reader] = loopback_pair();
+    if (Mode == SendMode::ZEROCOPY && !ZeroCopySends::enable(out_writer.get()))
+        throw_errno("SO_ZEROCOPY");
+
+    // producer: a known byte pattern
+    std::jthread producer([&, fd = in_writer.get()]() {
+        std::vector<std::uint8_t> chunk(CHUNK_SIZE);
+        for (std::size_t pos = 0; pos < total_bytes;)
+        {
+            const std::size_t length = std::min(CHUNK_SIZE, total_bytes - pos);
+            for (std::size_t i = 0; i < length; ++i)
+                chunk[i] = static_cast<std::uint8_t>((pos + i) % 251);
+            for (std::size_t sent = 0; sent < length;)
+            {
+                const ssize_t result = send(fd, chunk.data() + sent, length - sent, 0);
+                if (result < 0)
+                    throw_errno("producer send");
+                sent += static_cast<std::size_t>(result);
+            }
+            pos += length;
+        }
+    });
+
+    // consumer: verify the pattern; a byte overwritten before the kernel was done with it shows up here
+    // (루프백은 언제나 복사하지만, 그래도 완료 알림까지는 링버퍼를 붙잡고 있어야 함)
+    bool verified = true;
+    std::jthread consumer([&, fd = out_reader.get()]() {
+        std::vector<std::uint8_t> chunk(CHUNK_SIZE);
+        for (std::size_t pos = 0; pos < total_bytes;)
+        {
+            const ssize_t result = recv(fd, chunk.data(), chunk.size(), 0);
+            if (result <= 0)
+            {
+                verified = false;
+                break;
+            }
+            for (ssize_t i = 0; i < result; ++i)
+                if (chunk[i] != static_cast<std::uint8_t>((pos + i) % 251))
+                    verified = false;
+            pos += static_cast<std::size_t>(result);
+        }
+    });
+
+    nb::RingByteBuffer<> buf(ZEROCOPY_RING_BUF_SIZE);
+    BenchResult result{};
+
+    const auto started = Clock::now();
+    const double cpu_started = thread_cpu_seconds();
+    relay<Mode>(buf, in_reader.get(), out_writer.get(), total_bytes, send_size, result);
+    result.cpu_seconds = thread_cpu_seconds() - cpu_started;
+    producer.join();
+    consumer.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - started;
+
+    result.seconds = elapsed.count();
+    result.verified = verified;
+    return result;
+}
+
+/// Usage: 07_zerocopy_bench [total bytes per run]
+int main(int argc, char** argv)
+{
+    const std::size_t total_bytes = (argc == 2) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_TOTAL_BYTES;
+    if (argc > 2 || 0 == total_bytes)
+    {
+        std::cout << "Usage: 07_zerocopy_bench [total bytes per run]" << std::endl;
+        return 1;
+    }
+
+    const bool supported = ZeroCopySends::enable(loopback_pair().first.get());
+    std::cout << std::format("relaying {:.1f} MiB over loopback TCP through a {} byte ring buffer{}\n",
+                             total_bytes / (1024.0 * 1024.0), ZEROCOPY_RING_BUF_SIZE,
+                             supported ? "" : " (MSG_ZEROCOPY unsupported, copying only)");
+    std::cout << std::format("{:>10} | {:>10} | {:>10} | {:>12} | {:>14}\n", "send size", "sends", "MiB/s",
+                             "CPU s/GiB", "kernel copied");
+
+    bool all_is_well = true;
+
+    auto report = [&](std::size_t send_size, const char* name, const BenchResult& result) {
+        std::cout << std::format("{:>10} | {:>10} | {:>10.1f} | {:>12.3f} | {:>13.0f}%\n", send_size, name,
+                                 total_bytes / (1024.0 * 1024.0) / result.seconds,
+                                 result.cpu_seconds / (total_bytes / GIB),
+                                 result.zerocopy_sends ? 100.0 * result.copied / result.zerocopy_sends : 0.0);
+        all_is_well = all_is_well && result.verified;
+    };
+
+    for (const std::size_t send_size : {4 * 1024, 16 * 1024, 64 * 1024})
+    {
+        report(send_size, "copy", bench<SendMode::COPY>(total_bytes, send_size));
+        if (supported)
+            report(send_size, "zero-copy", bench<SendMode::ZEROCOPY>(total_bytes, send_size));
+    }
+
+    if (!all_is_well)
+        std::cout << "verification failed!" << std::endl;
+    return !all_is_well;
+}
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vtp
+{
+
+/// What `AsyncOutputSink::write()` does when the calling thread's buffer is full.
+enum class SinkFullPolicy
+{
+    DROP,  // count it as dropped, and return right away
+    BLOCK, // wait for the flusher to make room
+};
+
+/// Asynchronous output sink, so that workers never block on `std::cout`.
+///
+/// Each producer thread appends to its own SPSC byte ring (lock-free, no shared cache line),
+/// and a background flusher drains all the rings into the `std::ostream`.
+/// Memory is bounded to `buffer_capacity` per live producer thread; a ring left by an exited thread is reused.
+///
+/// Every message is written as a whole, so messages never interleave,
+/// but only the messages of the same thread keep their order.
+class AsyncOutputSink
+{
+public:
+    struct Options
+    {
+        std::size_t buffer_capacity = 64 * 1024; // per producer thread, rounded up to a power of 2
+        SinkFullPolicy full_policy = SinkFullPolicy::DROP;
+        std::chrono::milliseconds flush_interval{10};
+    };
+
+    struct Stats
+    {
+        std::uint64_t written_messages;
+        std::uint64_t written_bytes;
+        std::uint64_t dropped_messages; // `DROP` on a full ring, or longer than a whole ring
+        std::uint64_t producer_buffers; // rings ever allocated
+    };
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    /// SPSC byte ring: the owner thread writes, the flusher reads.
+    struct Buffer
+    {
+        explicit Buffer(std::size_t capacity) : data(std::make_unique<char[]>(capacity)), mask(capacity - 1)
+        {
+        }
+
+        auto capacity() const -> std::size_t
+        {
+            return mask + 1;
+        }
+
+        const std::unique_ptr<char[]> data;
+        const std::size_t mask;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> write_pos = 0;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> read_pos = 0;
+
+        // owner thread only, read by `stats()`
+        std::atomic<std::uint64_t> written_messages = 0;
+        std::atomic<std::uint64_t> dropped_messages = 0;
+
+        // a thread owns it, until that thread exits
+        std::atomic<bool> owned = true;
+        Buffer* next = nullptr;
+
+        void count(std::atomic<std::uint64_t>& counter)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+
+    /// Keeps a thread's rings alive and owned until the thread exits, even if the sink goes first.
+    struct ThreadBuffers
+    {
+        struct Entry
+        {
+            std::uint64_t sink_id;
+            std::shared_ptr<Buffer> buffer;
+        };
+        std::vector<Entry> entries;
+
+        ~ThreadBuffers()
+        {
+            for (const auto& entry : entries)
+                entry.buffer->owned.store(false, std::memory_order_release);
+        }
+    };
+
+public:
+    explicit AsyncOutputSink(std::ostream& out) : AsyncOutputSink(out, Options{})
+    {
+    }
+
+    AsyncOutputSink(std::ostream& out, Options options)
+        : _out(out), _options(normalized(options)), _id(next_sink_id()),
+          _flusher([this](std::stop_token stop) { flush_loop(stop); })
+    {
+    }
+
+    /// Writes out whatever is left; producer threads must be done writing.
+    ~AsyncOutputSink()
+    {
+        _flusher.request_stop();
+        wake_flusher();
+        _flusher.join();
+    }
+
+    AsyncOutputSink(const AsyncOutputSink&) = delete;
+    AsyncOutputSink& operator=(const AsyncOutputSink&) = delete;
+
+public:
+    /// Queues `message` to be written as a whole.
+    /// @return `false` if it was dropped
+    bool write(std::string_view message)
+    {
+        Buffer& buffer = thread_buffer();
+        const std::size_t capacity = buffer.capacity();
+        if (message.size() > capacity)
+        {
+            buffer.count(buffer.dropped_messages);
+            return false;
+        }
+
+        const std::size_t write_pos = buffer.write_pos.load(std::memory_order_relaxed);
+        std::size_t read_pos = buffer.read_pos.load(std::memory_order_acquire);
+        while (capacity - (write_pos - read_pos) < message.size())
+        {
+            if (SinkFullPolicy::DROP == _options.full_policy)
+            {
+                buffer.count(buffer.dropped_messages);
+                return false;
+            }
+
+            _wake.notify_one();
+            std::this_thread::yield();
+            read_pos = buffer.read_pos.load(std::memory_order_acquire);
+        }
+
+        // 두 조각으로 나뉠 수 있음
+        const std::size_t offset = write_pos & buffer.mask;
+        const std::size_t first = std::min(message.size(), capacity - offset);
+        message.copy(buffer.data.get() + offset, first);
+        message.copy(buffer.data.get(), message.size() - first, first);
+        buffer.write_pos.store(write_pos + message.size(), std::memory_order_release);
+        buffer.count(buffer.written_messages);
+
+        // 반 넘게 찼으면, 주기를 기다리지 않고 flusher 를 깨움 (이미 깨웠으면 생략)
+        if ((write_pos - read_pos) + message.size() > capacity / 2 &&
+            !_wake_pending.load(std::memory_order_relaxed) && !_wake_pending.exchange(true))
+            _wake.notify_one();
+        return true;
+    }
+
+    /// Formats into a thread-local string, then `write()`s it.
+    template <typename... Args>
+    bool print(std::format_string<Args...> fmt, Args&&... args)
+    {
+        thread_local std::string formatted;
+        formatted.clear();
+        std::format_to(std::back_inserter(formatted), fmt, std::forward<Args>(args)...);
+        return write(formatted);
+    }
+
+    /// Blocks until everything written so far is handed to the stream, and flushes it.
+    void flush()
+    {
+        // release: flusher 가 요청을 보면, 이 스레드가 그 전에 쓴 것(`write_pos`)도 보임
+        const std::uint64_t target = _flush_requested.fetch_add(1, std::memory_order_release) + 1;
+        wake_flusher();
+        while (_flushed.load(std::memory_order_acquire) < target)
+            std::this_thread::yield();
+    }
+
+    auto stats() const -> Stats
+    {
+        Stats stats{0, _written_bytes.load(std::memory_order_relaxed), 0, 0};
+        for (const Buffer* buffer = _buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+        {
+            stats.written_messages += buffer->written_messages.load(std::memory_order_relaxed);
+            stats.dropped_messages += buffer->dropped_messages.load(std::memory_order_relaxed);
+            ++stats.producer_buffers;
+        }
+        return stats;
+    }
+
+private:
+    auto thread_buffer() -> Buffer&
+    {
+        thread_local ThreadBuffers thread_buffers;
+
+        for (const auto& entry : thread_buffers.entries)
+            if (entry.sink_id == _id)
+                return *entry.buffer;
+
+        // 이미 파괴된 싱크의 링은 여기서만 잡고 있으니, 놓아줌
+        std::erase_if(thread_buffers.entries, [](const auto& entry) { return 1 == entry.buffer.use_count(); });
+
+        auto buffer = acquire_buffer();
+        thread_buffers.entries.push_back({_id, buffer});
+        return *buffer;
+    }
+
+    /// Takes over a ring left by an exited thread, or allocates a new one.
+    auto acquire_buffer() -> std::shared_ptr<Buffer>
+    {
+        for (Buffer* buffer = _buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+        {
+            bool owned = false;
+            if (buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+                return shared_of(buffer);
+        }
+
+        auto buffer = std::make_shared<Buffer>(_options.buffer_capacity);
+        {
+            std::lock_guard guard(_owned_buffers_lock);
+            _owned_buffers.push_back(buffer);
+        }
+
+        buffer->next = _buffers.load(std::memory_order_relaxed);
+        while (!_buffers.compare_exchange_weak(buffer->next, buffer.get(), std::memory_order_release,
+                                               std::memory_order_relaxed))
+            ;
+        return buffer;
+    }
+
+    auto shared_of(Buffer* buffer) -> std::shared_ptr<Buffer>
+    {
+        std::lock_guard guard(_owned_buffers_lock);
+        return *std::find_if(_owned_buffers.begin(), _owned_buffers.end(),
+                             [buffer](const auto& owned) { return owned.get() == buffer; });
+    }
+
+    /// Wakes the flusher up for sure: under `_wake_lock`, so that it can't be between checking its wait predicate
+    /// and going to sleep.
+    void wake_flusher()
+    {
+        {
+            std::lock_guard guard(_wake_lock);
+        }
+        _wake.notify_one();
+    }
+
+    void flush_loop(std::stop_token stop)
+    {
+        std::unique_lock lock(_wake_lock);
+        for (;;)
+        {
+            const std::uint64_t flush_requested = _flush_requested.load(std::memory_order_acquire);
+            const bool stopping = stop.stop_requested();
+
+            lock.unlock();
+            _wake_pending.store(false);
+            if (drain() || flush_requested > _flushed.load(std::memory_order_relaxed))
+                _out.flush();
+            _flushed.store(flush_requested, std::memory_order_release);
+            lock.lock();
+
+            if (stopping)
+                break;
+            // 쓰기가 깨우는 건 `_wake_pending` 으로 한 번만 하니 놓쳐도 주기만큼 늦을 뿐이지만,
+            // `flush()` 와 종료 요청은 조건으로 확인
+            _wake.wait_for(lock, _options.flush_interval, [&]() {
+                return stop.stop_requested() ||
+                       _flush_requested.load(std::memory_order_relaxed) > _flushed.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    /// @return whether anything was written
+    bool drain()
+    {
+        bool wrote = false;
+        for (Buffer* buffer = _buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+        {
+            const std::size_t read_pos = buffer->read_pos.load(std::memory_order_relaxed);
+            const std::size_t write_pos = buffer->write_pos.load(std::memory_order_acquire);
+            if (read_pos == write_pos)
+                continue;
+
+            const std::size_t length = write_pos - read_pos;
+            const std::size_t offset = read_pos & buffer->mask;
+            const std::size_t first = std::min(length, buffer->capacity() - offset);
+            _out.write(buffer->data.get() + offset, static_cast<std::streamsize>(first));
+            _out.write(buffer->data.get(), static_cast<std::streamsize>(length - first));
+            buffer->read_pos.store(write_pos, std::memory_order_release);
+
+            _written_bytes.fetch_add(length, std::memory_order_relaxed);
+            wrote = true;
+        }
+        return wrote;
+    }
+
+    static auto normalized(Options options) -> Options
+    {
+        options.buffer_capacity = std::bit_ceil(std::max<std::size_t>(options.buffer_capacity, 1024));
+        return options;
+    }
+
+    static auto next_sink_id() -> std::uint64_t
+    {
+        static std::atomic<std::uint64_t> next_id = 1;
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::ostream& _out;
+    const Options _options;
+    const std::uint64_t _id;
+
+    // lock-free list of every ring, only ever pushed to
+    std::atomic<Buffer*> _buffers = nullptr;
+    std::vector<std::shared_ptr<Buffer>> _owned_buffers;
+    std::mutex _owned_buffers_lock;
+
+    // flusher only
+    std::atomic<std::uint64_t> _written_bytes = 0;
+
+    std::atomic<std::uint64_t> _flush_requested = 0;
+    std::atomic<std::uint64_t> _flushed = 0;
+
+    std::atomic<bool> _wake_pending = false;
+    std::mutex _wake_lock;
+    std::condition_variable _wake;
+    std::jthread _flusher;
+};
+
+} // namespace vtp
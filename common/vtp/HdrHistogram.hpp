@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace vtp
+{
+
+/// High dynamic range histogram of non-negative integer values, e.g. latencies in nanoseconds.
+///
+/// Log-linear buckets, like HdrHistogram: every power of 2 is split into `2^(SUB_BUCKET_BITS - 1)` linear buckets,
+/// so any recorded value is reported within ~1/2^(SUB_BUCKET_BITS - 1) relative error (~3% by default).
+/// Values beyond `2^MAX_VALUE_BITS` are clamped into the last bucket.
+///
+/// `record()` is a relaxed atomic increment, so any thread can record into it;
+/// for hot paths, record into per-thread histograms and `merge()` them when reporting.
+class HdrHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr int MAX_VALUE_BITS = 40; // ~18 minutes in nanoseconds
+
+private:
+    static constexpr std::uint64_t HALF_SUB_BUCKETS = std::uint64_t(1) << (SUB_BUCKET_BITS - 1);
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << MAX_VALUE_BITS) - 1;
+
+    // 2 octaves of exact values, then `HALF_SUB_BUCKETS` for each octave up to `MAX_VALUE`
+    static constexpr std::size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS;
+
+    static constexpr auto bucket_index_of(std::uint64_t value) -> std::size_t
+    {
+        // [0, 2 * HALF_SUB_BUCKETS) are exact, then every power of 2 gets HALF_SUB_BUCKETS buckets
+        const int msb = std::bit_width(value) - 1;
+        const int shift = std::max(0, msb - (SUB_BUCKET_BITS - 1));
+        return static_cast<std::size_t>(shift * HALF_SUB_BUCKETS + (value >> shift));
+    }
+
+    static constexpr auto highest_equivalent_value(std::size_t index) -> std::uint64_t
+    {
+        if (index < 2 * HALF_SUB_BUCKETS)
+            return index;
+
+        const auto shift = index / HALF_SUB_BUCKETS - 1;
+        const auto sub_bucket = index - shift * HALF_SUB_BUCKETS;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+public:
+    void record(std::uint64_t value)
+    {
+        value = std::min(value, MAX_VALUE);
+        _buckets[bucket_index_of(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+
+        auto max = _max.load(std::memory_order_relaxed);
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            ;
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> duration)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(ns > 0 ? static_cast<std::uint64_t>(ns) : 0);
+    }
+
+    void merge(const HdrHistogram& other)
+    {
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+            if (const auto count = other._buckets[i].load(std::memory_order_relaxed))
+                _buckets[i].fetch_add(count, std::memory_order_relaxed);
+
+        _count.fetch_add(other.count(), std::memory_order_relaxed);
+        _sum.fetch_add(other._sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        const auto other_max = other.max();
+        auto max = _max.load(std::memory_order_relaxed);
+        while (other_max > max && !_max.compare_exchange_weak(max, other_max, std::memory_order_relaxed))
+            ;
+    }
+
+    /// Not atomic as a whole; values recorded meanwhile might be partially lost.
+    void reset()
+    {
+        for (auto& bucket : _buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+public:
+    auto count() const -> std::uint64_t
+    {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    auto max() const -> std::uint64_t
+    {
+        return _max.load(std::memory_order_relaxed);
+    }
+
+    auto mean() const -> double
+    {
+        const auto count = this->count();
+        return count ? static_cast<double>(_sum.load(std::memory_order_relaxed)) / count : 0.0;
+    }
+
+    /// Highest value equivalent to the one at `percent` (0 ~ 100), capped at `max()`.
+    auto percentile(double percent) const -> std::uint64_t
+    {
+        const auto count = this->count();
+        if (0 == count)
+            return 0;
+
+        const auto rank =
+            std::max<std::uint64_t>(1, static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(count) + 0.5));
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(highest_equivalent_value(i), max());
+        }
+        return max();
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> _buckets{};
+    std::atomic<std::uint64_t> _count = 0;
+    std::atomic<std::uint64_t> _sum = 0;
+    std::atomic<std::uint64_t> _max = 0;
+};
+
+} // namespace vtp
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace vtp
+{
+
+/// Ring byte buffer whose pages are mapped twice back-to-back in virtual memory,
+/// so `[data() + pos, data() + pos + capacity())` is always one contiguous span.
+///
+/// Drop-in replacement for `nb::RingByteBuffer<>`,
+/// except that `consecutive_read_length()` and `consecutive_write_length()` never split.
+///
+/// Capacity is rounded up to the page size (Linux) or the allocation granularity (Windows; 64 KiB).
+class MirroredRingBuffer
+{
+public:
+    explicit MirroredRingBuffer(std::size_t min_capacity)
+    {
+        const std::size_t granularity = allocation_granularity();
+        _capacity = (min_capacity + granularity - 1) / granularity * granularity;
+        if (0 == _capacity)
+            _capacity = granularity;
+
+        _data = map_mirrored(_capacity);
+    }
+
+    ~MirroredRingBuffer()
+    {
+        if (_data)
+            unmap_mirrored(_data, _capacity);
+    }
+
+    MirroredRingBuffer(const MirroredRingBuffer&) = delete;
+    MirroredRingBuffer& operator=(const MirroredRingBuffer&) = delete;
+
+    MirroredRingBuffer(MirroredRingBuffer&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)), _capacity(std::exchange(other._capacity, 0)),
+          _read_pos(std::exchange(other._read_pos, 0)), _used(std::exchange(other._used, 0))
+    {
+    }
+
+    MirroredRingBuffer& operator=(MirroredRingBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (_data)
+                unmap_mirrored(_data, _capacity);
+
+            _data = std::exchange(other._data, nullptr);
+            _capacity = std::exchange(other._capacity, 0);
+            _read_pos = std::exchange(other._read_pos, 0);
+            _used = std::exchange(other._used, 0);
+        }
+        return *this;
+    }
+
+public: // Capacity
+    auto capacity() const -> std::size_t
+    {
+        return _capacity;
+    }
+
+    bool empty() const
+    {
+        return 0 == _used;
+    }
+
+    bool full() const
+    {
+        return _capacity == _used;
+    }
+
+    auto used_space() const -> std::size_t
+    {
+        return _used;
+    }
+
+    auto available_space() const -> std::size_t
+    {
+        return _capacity - _used;
+    }
+
+public: // Direct access
+    auto data() -> std::byte*
+    {
+        return _data;
+    }
+
+    auto data() const -> const std::byte*
+    {
+        return _data;
+    }
+
+    auto read_pos() const -> std::size_t
+    {
+        return _read_pos;
+    }
+
+    auto write_pos() const -> std::size_t
+    {
+        const std::size_t pos = _read_pos + _used;
+        return (pos >= _capacity) ? pos - _capacity : pos;
+    }
+
+    /// Always `used_space()`, thanks to the mirrored mapping.
+    auto consecutive_read_length() const -> std::size_t
+    {
+        return _used;
+    }
+
+    /// Always `available_space()`, thanks to the mirrored mapping.
+    auto consecutive_write_length() const -> std::size_t
+    {
+        return _capacity - _used;
+    }
+
+    void move_read_pos(std::size_t length)
+    {
+        assert(length <= _used);
+
+        _read_pos += length;
+        if (_read_pos >= _capacity)
+            _read_pos -= _capacity;
+        _used -= length;
+    }
+
+    void move_write_pos(std::size_t length)
+    {
+        assert(length <= available_space());
+
+        _used += length;
+    }
+
+public: // Modifiers
+    bool try_write(const void* src, std::size_t length)
+    {
+        if (available_space() < length)
+            return false;
+
+        std::memcpy(_data + write_pos(), src, length);
+        move_write_pos(length);
+        return true;
+    }
+
+    bool try_peek(void* dest, std::size_t length) const
+    {
+        if (_used < length)
+            return false;
+
+        std::memcpy(dest, _data + _read_pos, length);
+        return true;
+    }
+
+    bool try_read(void* dest, std::size_t length)
+    {
+        if (!try_peek(dest, length))
+            return false;
+
+        move_read_pos(length);
+        return true;
+    }
+
+    void clear()
+    {
+        _read_pos = 0;
+        _used = 0;
+    }
+
+private:
+#if defined(_WIN32)
+    static auto allocation_granularity() -> std::size_t
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+    }
+
+    static auto last_error(const char* what) -> std::system_error
+    {
+        return std::system_error(static_cast<int>(GetLastError()), std::system_category(), what);
+    }
+
+    /// https://learn.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-virtualalloc2#examples
+    static auto map_mirrored(std::size_t size) -> std::byte*
+    {
+        // reserve 2 * size of placeholder, then split it in half
+        auto placeholder1 = static_cast<std::byte*>(VirtualAlloc2(
+            nullptr, nullptr, 2 * size, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0));
+        if (!placeholder1)
+            throw last_error("VirtualAlloc2");
+
+        if (!VirtualFree(placeholder1, size, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+        {
+            const auto err = last_error("VirtualFree");
+            VirtualFree(placeholder1, 0, MEM_RELEASE);
+            throw err;
+        }
+        std::byte* placeholder2 = placeholder1 + size;
+
+        HANDLE section = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                           static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32),
+                                           static_cast<DWORD>(size & 0xFFFF'FFFF), nullptr);
+        if (!section)
+        {
+            const auto err = last_error("CreateFileMapping");
+            VirtualFree(placeholder1, 0, MEM_RELEASE);
+            VirtualFree(placeholder2, 0, MEM_RELEASE);
+            throw err;
+        }
+
+        // map the same section into both placeholders
+        void* view1 = MapViewOfFile3(section, nullptr, placeholder1, 0, size, MEM_REPLACE_PLACEHOLDER,
+                                     PAGE_READWRITE, nullptr, 0);
+        if (!view1)
+        {
+            const auto err = last_error("MapViewOfFile3");
+            CloseHandle(section);
+            VirtualFree(placeholder1, 0, MEM_RELEASE);
+            VirtualFree(placeholder2, 0, MEM_RELEASE);
+            throw err;
+        }
+
+        void* view2 = MapViewOfFile3(section, nullptr, placeholder2, 0, size, MEM_REPLACE_PLACEHOLDER,
+                                     PAGE_READWRITE, nullptr, 0);
+        if (!view2)
+        {
+            const auto err = last_error("MapViewOfFile3");
+            UnmapViewOfFile(view1);
+            CloseHandle(section);
+            VirtualFree(placeholder2, 0, MEM_RELEASE);
+            throw err;
+        }
+
+        // views keep the section alive
+        CloseHandle(section);
+        return static_cast<std::byte*>(view1);
+    }
+
+    static void unmap_mirrored(std::byte* data, std::size_t size)
+    {
+        UnmapViewOfFile(data);
+        UnmapViewOfFile(data + size);
+    }
+#else
+    static auto allocation_granularity() -> std::size_t
+    {
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    static auto last_error(const char* what) -> std::system_error
+    {
+        return std::system_error(errno, std::system_category(), what);
+    }
+
+    static auto map_mirrored(std::size_t size) -> std::byte*
+    {
+        const int fd = memfd_create("vtp_mirrored_ring_buffer", MFD_CLOEXEC);
+        if (-1 == fd)
+            throw last_error("memfd_create");
+
+        if (-1 == ftruncate(fd, static_cast<off_t>(size)))
+        {
+            const auto err = last_error("ftruncate");
+            close(fd);
+            throw err;
+        }
+
+        // reserve 2 * size of address space, then map the same pages into both halves
+        void* reserved = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == reserved)
+        {
+            const auto err = last_error("mmap");
+            close(fd);
+            throw err;
+        }
+
+        auto base = static_cast<std::byte*>(reserved);
+        if (MAP_FAILED == mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) ||
+            MAP_FAILED == mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0))
+        {
+            const auto err = last_error("mmap");
+            munmap(base, 2 * size);
+            close(fd);
+            throw err;
+        }
+
+        // mappings keep the memfd alive
+        close(fd);
+        return base;
+    }
+
+    static void unmap_mirrored(std::byte* data, std::size_t size)
+    {
+        munmap(data, 2 * size);
+    }
+#endif
+
+private:
+    std::byte* _data = nullptr;
+    std::size_t _capacity = 0;
+
+    std::size_t _read_pos = 0;
+    std::size_t _used = 0;
+};
+
+} // namespace vtp